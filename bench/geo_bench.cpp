@@ -0,0 +1,85 @@
+#include "GeoBatch.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+// Positions scattered around a route, from below sea level up to a few kilometres.
+// Compares the scalar EllipsoidModel conversions with the batch ones and reports the largest difference.
+template<typename F>
+double measure(F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+void run(const vsg::EllipsoidModel &model, int count)
+{
+    std::mt19937 random(count);
+    std::uniform_real_distribution<double> lat(-80.0, 80.0);
+    std::uniform_real_distribution<double> lon(-180.0, 180.0);
+    std::uniform_real_distribution<double> alt(-100.0, 5000.0);
+
+    CoordinateArrays lla;
+    lla.resize(count);
+    for (int i = 0; i < count; ++i)
+        lla.set(i, {lat(random), lon(random), alt(random)});
+
+    GeoBatch batch(model);
+
+    std::vector<vsg::dvec3> scalarECEF(count);
+    auto scalarToECEF = measure([&]()
+    {
+        for (int i = 0; i < count; ++i)
+            scalarECEF[i] = model.convertLatLongAltitudeToECEF(lla.get(i));
+    });
+
+    CoordinateArrays ecef;
+    auto batchToECEF = measure([&]() { batch.toECEF(lla, ecef); });
+
+    std::vector<vsg::dvec3> scalarLLA(count);
+    auto scalarToLLA = measure([&]()
+    {
+        for (int i = 0; i < count; ++i)
+            scalarLLA[i] = model.convertECEFToLatLongAltitude(scalarECEF[i]);
+    });
+
+    CoordinateArrays back;
+    auto batchToLLA = measure([&]() { batch.toLatLongAltitude(ecef, back); });
+
+    double ecefError = 0.0;
+    double latError = 0.0;
+    double altError = 0.0;
+    for (int i = 0; i < count; ++i)
+    {
+        ecefError = std::max(ecefError, vsg::length(ecef.get(i) - scalarECEF[i]));
+        latError = std::max(latError, std::abs(back.x[i] - scalarLLA[i].x));
+        altError = std::max(altError, std::abs(back.z[i] - scalarLLA[i].z));
+    }
+
+    std::printf("positions %d\n", count);
+    std::printf("  %-12s %10s %10s\n", "", "scalar, ms", "batch, ms");
+    std::printf("  %-12s %10.2f %10.2f\n", "lla to ecef", scalarToECEF, batchToECEF);
+    std::printf("  %-12s %10.2f %10.2f\n", "ecef to lla", scalarToLLA, batchToLLA);
+    std::printf("  max difference: ecef %.3g m, latitude %.3g deg, altitude %.3g m\n", ecefError, latError, altError);
+}
+
+int main(int argc, char *argv[])
+{
+    auto model = vsg::EllipsoidModel::create();
+
+    if(argc >= 2)
+    {
+        run(*model, std::atoi(argv[1]));
+        return 0;
+    }
+
+    for (int count : {1000, 10000, 100000, 1000000})
+        run(*model, count);
+
+    return 0;
+}
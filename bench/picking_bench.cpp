@@ -0,0 +1,221 @@
+#include "sceneobjects.h"
+#include "tools.h"
+#include "Picker.h"
+#include <vsg/app/Camera.h>
+#include <vsg/nodes/MatrixTransform.h>
+#include <vsg/ui/PointerEvent.h>
+#include <vsg/utils/Builder.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+// Synthetic route: a grid of flat tiles with boxes standing on them and long thin
+// "trajectories" laid across each tile. Objects share one model, as placed objects do.
+struct SceneSize
+{
+    int tiles;
+    int objects;
+    int trajectories;
+};
+
+constexpr float TILE_SIZE = 1000.0f;
+constexpr uint32_t WIDTH = 1920;
+constexpr uint32_t HEIGHT = 1080;
+
+vsg::ref_ptr<vsg::Group> createScene(const SceneSize &size, vsg::ref_ptr<vsg::Builder> builder, std::mt19937 &random)
+{
+    auto root = vsg::Group::create();
+
+    vsg::StateInfo wireState;
+    wireState.lighting = false;
+    wireState.wireframe = true;
+    auto wireBox = builder->createBox({}, wireState);
+
+    vsg::GeometryInfo modelInfo;
+    modelInfo.dx.set(4.0f, 0.0f, 0.0f);
+    modelInfo.dy.set(0.0f, 4.0f, 0.0f);
+    modelInfo.dz.set(0.0f, 0.0f, 8.0f);
+    auto model = builder->createBox(modelInfo);
+
+    vsg::GeometryInfo terrainInfo;
+    terrainInfo.dx.set(TILE_SIZE, 0.0f, 0.0f);
+    terrainInfo.dy.set(0.0f, TILE_SIZE, 0.0f);
+    terrainInfo.dz.set(0.0f, 0.0f, 1.0f);
+    terrainInfo.position.set(TILE_SIZE / 2.0f, TILE_SIZE / 2.0f, -0.5f);
+
+    std::uniform_real_distribution<double> onTile(0.0, TILE_SIZE);
+
+    auto side = static_cast<int>(std::ceil(std::sqrt(size.tiles)));
+    auto objectsPerTile = size.objects / std::max(size.tiles, 1);
+    auto trajectoriesPerTile = size.trajectories / std::max(size.tiles, 1);
+
+    for (int t = 0; t < size.tiles; ++t)
+    {
+        auto tile = vsg::MatrixTransform::create(vsg::translate(static_cast<double>(TILE_SIZE) * (t % side), static_cast<double>(TILE_SIZE) * (t / side), 0.0));
+        tile->addChild(builder->createBox(terrainInfo));
+
+        for (int o = 0; o < objectsPerTile; ++o)
+        {
+            auto object = route::SceneObject::create(wireBox, model);
+            object->setPosition({onTile(random), onTile(random), 4.0});
+            tile->addChild(object);
+        }
+
+        for (int k = 0; k < trajectoriesPerTile; ++k)
+        {
+            vsg::GeometryInfo railInfo;
+            railInfo.dx.set(TILE_SIZE, 0.0f, 0.0f);
+            railInfo.dy.set(0.0f, 1.5f, 0.0f);
+            railInfo.dz.set(0.0f, 0.0f, 0.2f);
+            railInfo.position.set(TILE_SIZE / 2.0f, static_cast<float>(onTile(random)), 0.1f);
+            tile->addChild(builder->createBox(railInfo));
+        }
+
+        root->addChild(tile);
+    }
+    return root;
+}
+
+vsg::ref_ptr<vsg::Camera> createCamera(const SceneSize &size)
+{
+    auto side = std::ceil(std::sqrt(size.tiles)) * static_cast<double>(TILE_SIZE);
+    vsg::dvec3 centre(side / 2.0, side / 2.0, 0.0);
+
+    //oblique view so that the upper part of the screen looks past the route
+    auto lookAt = vsg::LookAt::create(vsg::dvec3(-200.0, -200.0, 150.0), centre, vsg::dvec3(0.0, 0.0, 1.0));
+    auto perspective = vsg::Perspective::create(60.0, static_cast<double>(WIDTH) / static_cast<double>(HEIGHT), 0.1, side * 4.0);
+    return vsg::Camera::create(perspective, lookAt, vsg::ViewportState::create(0, 0, WIDTH, HEIGHT));
+}
+
+enum Hit
+{
+    Terrain,
+    Object,
+    Miss,
+    HitCount
+};
+
+Hit classify(const vsg::LineSegmentIntersector::Intersections &intersections)
+{
+    if(intersections.empty())
+        return Miss;
+    for (auto node : intersections.front()->nodePath)
+    {
+        if(node->is_compatible(typeid(route::SceneObject)))
+            return Object;
+    }
+    return Terrain;
+}
+
+void report(const char *name, std::vector<double> &samples)
+{
+    if(samples.empty())
+    {
+        std::printf("  %-8s %8d\n", name, 0);
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p)
+    {
+        auto index = static_cast<size_t>(p * static_cast<double>(samples.size() - 1));
+        return samples[index];
+    };
+    std::printf("  %-8s %8zu %10.1f %10.1f %10.1f %10.1f\n", name, samples.size(),
+                percentile(0.5), percentile(0.9), percentile(0.99), samples.back());
+}
+
+bool identical(const vsg::LineSegmentIntersector::Intersections &lhs, const vsg::LineSegmentIntersector::Intersections &rhs)
+{
+    if(lhs.size() != rhs.size())
+        return false;
+    for (size_t i = 0; i < lhs.size(); ++i)
+    {
+        if(lhs[i]->ratio != rhs[i]->ratio || lhs[i]->nodePath != rhs[i]->nodePath)
+            return false;
+    }
+    return true;
+}
+
+template<typename F>
+double measure(F pick, vsg::LineSegmentIntersector::Intersections &intersections)
+{
+    auto start = std::chrono::steady_clock::now();
+    intersections = pick();
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(finish - start).count();
+}
+
+void run(const SceneSize &size, int picks)
+{
+    std::mt19937 random(42);
+
+    auto builder = vsg::Builder::create();
+    auto root = createScene(size, builder, random);
+    auto camera = createCamera(size);
+    auto picker = Picker::create(root, std::vector<const vsg::Node*>{root.get()});
+
+    std::uniform_int_distribution<int32_t> x(0, WIDTH - 1);
+    std::uniform_int_distribution<int32_t> y(0, HEIGHT - 1);
+
+    std::vector<double> serial[HitCount];
+    std::vector<double> parallel[HitCount];
+    int mismatches = 0;
+
+    for (int i = 0; i < picks; ++i)
+    {
+        auto event = vsg::ButtonPressEvent::create(nullptr, vsg::clock::now(), x(random), y(random), vsg::BUTTON_MASK_1, 1);
+
+        vsg::LineSegmentIntersector::Intersections expected;
+        auto serialTime = measure([&]() { return route::testIntersections(*event, root, camera); }, expected);
+
+        vsg::LineSegmentIntersector::Intersections found;
+        auto parallelTime = measure([&]() { return picker->intersect(*event, *camera); }, found);
+
+        auto hit = classify(expected);
+        serial[hit].push_back(serialTime);
+        parallel[hit].push_back(parallelTime);
+
+        if(!identical(expected, found))
+            ++mismatches;
+    }
+
+    std::printf("tiles %d, objects %d, trajectories %d\n", size.tiles, size.objects, size.trajectories);
+    std::printf("  %-8s %8s %10s %10s %10s %10s\n", "hit", "picks", "p50, us", "p90, us", "p99, us", "max, us");
+    std::printf(" serial\n");
+    report("terrain", serial[Terrain]);
+    report("object", serial[Object]);
+    report("miss", serial[Miss]);
+    std::printf(" parallel\n");
+    report("terrain", parallel[Terrain]);
+    report("object", parallel[Object]);
+    report("miss", parallel[Miss]);
+    if(mismatches > 0)
+        std::printf(" parallel results differ from serial in %d picks\n", mismatches);
+}
+
+int main(int argc, char *argv[])
+{
+    int picks = 1000;
+
+    if(argc >= 4)
+    {
+        if(argc >= 5)
+            picks = std::atoi(argv[4]);
+        run({std::atoi(argv[1]), std::atoi(argv[2]), std::atoi(argv[3])}, picks);
+        return 0;
+    }
+
+    const SceneSize sizes[] = {
+        {1, 100, 10},
+        {4, 1000, 40},
+        {16, 10000, 160},
+        {64, 100000, 640}
+    };
+    for (const auto &size : sizes)
+        run(size, picks);
+
+    return 0;
+}
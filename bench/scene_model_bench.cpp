@@ -0,0 +1,153 @@
+#include "SceneObjectsModel.h"
+#include "undo-redo.h"
+#include "sceneobjects.h"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QScrollBar>
+#include <QTemporaryDir>
+#include <QTreeView>
+#include <cstdio>
+#include <cstdlib>
+
+// One tile with a large flat list of objects, as imported routes produce.
+// Times the tree view operations that map nodes back to rows.
+vsg::ref_ptr<route::SceneGroup> createRoot(int children)
+{
+    auto root = route::SceneGroup::create();
+    auto tile = route::SceneGroup::create();
+    tile->setName("tile");
+
+    auto wireBox = vsg::Group::create();
+    auto model = vsg::Group::create();
+    for (int i = 0; i < children; ++i)
+    {
+        auto object = route::SceneObject::create(wireBox, model);
+        object->setName(QString::number(i));
+        tile->addChild(object);
+    }
+    root->addChild(tile);
+    return root;
+}
+
+template<typename F>
+double measure(F f)
+{
+    QElapsedTimer timer;
+    timer.start();
+    f();
+    return static_cast<double>(timer.nsecsElapsed()) / 1.0e6;
+}
+
+// Adds an object, deletes it, saves the history and restores it in a fresh session on the same tree,
+// where the object exists only inside the saved removal. Undoing both steps must bring it back and take it away again.
+bool checkHistory(vsg::ref_ptr<route::MVCObject> root)
+{
+    auto tile = root->at(0);
+    auto children = tile->childrenCount();
+    QTemporaryDir dir;
+    auto path = dir.filePath("route.undo");
+    QByteArray revision("revision");
+
+    {
+        auto registry = ObjectRegistry::create();
+        registry->addTree(root);
+        SceneModel model(root);
+        model.setRegistry(registry);
+        QUndoStack stack;
+        model.setUndoStack(&stack);
+
+        auto object = route::SceneObject::create(vsg::Group::create(), vsg::Group::create());
+        object->setName("added");
+        stack.push(new AddSceneObject(&model, tile, object));
+        stack.push(new RemoveNode(&model, model.reveal(object.get())));
+        if(!UndoHistory::save(path, revision, &stack, *registry))
+            return false;
+    }
+
+    auto registry = ObjectRegistry::create();
+    registry->addTree(root);
+    SceneModel model(root);
+    model.setRegistry(registry);
+    QUndoStack stack;
+    model.setUndoStack(&stack);
+    if(!UndoHistory::restore(path, revision, &stack, &model, *registry) || stack.count() != 2 || stack.index() != 2)
+        return false;
+
+    stack.undo();
+    if(tile->childrenCount() != children + 1 || tile->at(children)->getName() != "added")
+        return false;
+    stack.undo();
+    if(tile->childrenCount() != children)
+        return false;
+    stack.redo();
+    stack.redo();
+    return tile->childrenCount() == children;
+}
+
+int main(int argc, char *argv[])
+{
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    int children = argc >= 2 ? std::atoi(argv[1]) : 50000;
+
+    auto root = createRoot(children);
+    auto tile = root->at(0);
+
+    SceneModel model(root);
+    QTreeView view;
+    view.setUniformRowHeights(true);
+    view.resize(800, 600);
+    view.setModel(&model);
+    view.show();
+    app.processEvents();
+
+    auto tileIndex = model.index(0, 0);
+
+    auto expand = measure([&]()
+    {
+        view.expand(tileIndex);
+        app.processEvents();
+    });
+
+    auto scroll = measure([&]()
+    {
+        view.verticalScrollBar()->setValue(view.verticalScrollBar()->maximum());
+        app.processEvents();
+        view.scrollToTop();
+        app.processEvents();
+    });
+
+    //what selection mapping does for every selected row
+    auto parents = measure([&]()
+    {
+        for (int i = 0; i < children; ++i)
+            model.parent(model.index(i, 0, tileIndex));
+    });
+
+    auto indices = measure([&]()
+    {
+        for (int i = 0; i < children; ++i)
+            model.reveal(tile->at(i));
+    });
+
+    //the same lookups after the first child is removed, so that every cached row is stale
+    model.removeRows(0, 1, tileIndex);
+    auto shifted = measure([&]()
+    {
+        for (int i = 0; i < children - 1; ++i)
+            model.index(tile->at(i));
+    });
+
+    std::printf("children %d\n", children);
+    std::printf("  %-24s %10.2f ms\n", "expand", expand);
+    std::printf("  %-24s %10.2f ms\n", "scroll to end and back", scroll);
+    std::printf("  %-24s %10.2f ms\n", "parent() of all rows", parents);
+    std::printf("  %-24s %10.2f ms\n", "reveal(node) of all rows", indices);
+    std::printf("  %-24s %10.2f ms\n", "index(node) after removal", shifted);
+
+    auto history = checkHistory(root);
+    std::printf("  %-24s %10s\n", "history round trip", history ? "ok" : "FAILED");
+
+    return history ? 0 : 1;
+}
@@ -57,7 +57,7 @@ void AddRails::apply(vsg::ButtonPressEvent &buttonPress)
 {
     if(!isVisible() || buttonPress.button != 1)
         return;
-    auto isections = route::testIntersections(buttonPress, _database->root, _camera);
+    auto isections = intersect(buttonPress, Picker::Terrain | Picker::Connectors);
     if(isections.empty())
         return;
     auto isection = isections.front();
@@ -0,0 +1,57 @@
+#ifndef CHANGESET_H
+#define CHANGESET_H
+
+#include "ObjectRegistry.h"
+#include <vector>
+#include <algorithm>
+
+//Objects changed by one undo step, published by SceneModel once the step is done.
+//Steps that change objects behind the model's back only set other, subscribers then refresh everything.
+struct ChangeSet
+{
+    std::vector<ObjectRegistry::ID> transformed;
+    std::vector<ObjectRegistry::ID> renamed;
+    std::vector<ObjectRegistry::ID> added;
+    std::vector<ObjectRegistry::ID> removed;
+    bool other = false;
+
+    bool empty() const
+    {
+        return transformed.empty() && renamed.empty() && added.empty() && removed.empty() && !other;
+    }
+
+    //true when any of the sorted ids is in the set, or when the set can not tell
+    bool affects(const std::vector<ObjectRegistry::ID> &ids) const
+    {
+        if(other)
+            return true;
+        auto hit = [&ids](const std::vector<ObjectRegistry::ID> &changed)
+        {
+            for (auto id : changed)
+                if(std::binary_search(ids.begin(), ids.end(), id))
+                    return true;
+            return false;
+        };
+        return hit(transformed) || hit(renamed) || hit(added) || hit(removed);
+    }
+
+    void normalize()
+    {
+        for (auto list : {&transformed, &renamed, &added, &removed})
+        {
+            std::sort(list->begin(), list->end());
+            list->erase(std::unique(list->begin(), list->end()), list->end());
+        }
+    }
+};
+
+//undo steps that make all of their changes through SceneModel, so the published set is complete
+class PublishedCommand
+{
+public:
+    virtual ~PublishedCommand() = default;
+
+    virtual bool published() const { return true; }
+};
+
+#endif // CHANGESET_H
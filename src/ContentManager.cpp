@@ -3,6 +3,7 @@
 #include "sceneobjectvisitor.h"
 #include "ui_ContentManager.h"
 #include <QSettings>
+#include <QDir>
 #include <vsg/io/read.h>
 #include "DatabaseManager.h"
 #include "trajectory.h"
@@ -39,7 +40,7 @@ bool ContentManager::addToTrack(vsg::ref_ptr<route::SceneObject> obj, const Foun
     transform->setValue(app::PROP, coord);
     obj->reset();
     auto model = _database->tilesModel;
-    _database->undoStack->push(new AddSceneObject(model, model->index(traj), transform));
+    _database->undoStack->push(new AddSceneObject(model, model->reveal(traj), transform));
     traj->updateAttached();
     emit sendObject(obj);
     return true;
@@ -78,7 +79,7 @@ void ContentManager::apply(vsg::ButtonPressEvent &buttonPress)
 {
     if(!isVisible() || buttonPress.button != 1)
         return;
-    auto isections = route::testIntersections(buttonPress, _database->root, _camera);
+    auto isections = intersect(buttonPress, Picker::Terrain | Picker::Objects | Picker::Tracks);
     if(isections.empty())
         return;
     auto isection = isections.front();
@@ -97,7 +98,9 @@ void ContentManager::apply(vsg::ButtonPressEvent &buttonPress)
     }
     auto path = _fsmodel->filePath(activeFile).toStdString();
 
-    auto load = [database=_database, useLinks=ui->useLinks->isChecked(), path]()
+    auto asset = QDir(_fsmodel->rootPath()).relativeFilePath(_fsmodel->filePath(activeFile)).toStdString();
+
+    auto load = [database=_database, useLinks=ui->useLinks->isChecked(), path, asset]()
     {
         vsg::ref_ptr<route::SceneObject> object;
         auto node = vsg::read_cast<vsg::Node>(path, database->builder->options);
@@ -111,6 +114,7 @@ void ContentManager::apply(vsg::ButtonPressEvent &buttonPress)
             object = route::SingleLoader::create(database->getStdWireBox(), node, path);
         else
             object = route::SceneObject::create(database->getStdWireBox(), node);
+        object->setValue(FacetIndex::ASSET_KEY, asset);
 
         return object;
     };
@@ -133,28 +137,38 @@ void ContentManager::apply(vsg::ButtonPressEvent &buttonPress)
         }
         else
         {
+            //every placement found along the path goes into one undo step
+            std::vector<AddSceneObjects::Placement> placements;
+            std::vector<route::Trajectory*> trajectories;
+
             route::AddCast visitor;
-            visitor.tileFunction = [this, model, object, &isection, type](route::Tile *tile)
+            visitor.tileFunction = [model, object, &isection, type, &placements](route::Tile *tile)
             {
-                auto model = _database->tilesModel;
-                auto index = model->index(type, 0, model->index(tile));
+                auto index = model->index(type, 0, model->reveal(tile));
                 auto world = isection->worldIntersection;
                 auto position = vsg::inverse(tile->transform->matrix) * world;
                 object->setPosition(position);
-                _database->undoStack->push(new AddSceneObject(model, index, object));
+                placements.emplace_back(static_cast<route::MVCObject*>(index.internalPointer()), object);
                 return true;
             };
-            visitor.trjFunction = [this, model, object, &isection](route::Trajectory *traj)
+            visitor.trjFunction = [object, &isection, &placements, &trajectories](route::Trajectory *traj)
             {
                 auto coord = traj->invert(isection->worldIntersection);
                 auto trjObject = route::TrajectoryObject::create();
                 trjObject->coord = coord;
                 trjObject->addChild(object);
-                _database->undoStack->push(new AddSceneObject(model, model->index(traj), trjObject));
-                traj->updateAttached();
+                placements.emplace_back(traj, trjObject);
+                trajectories.push_back(traj);
                 return true;
             };
             vsg::visit(visitor, isection->nodePath);
+
+            if(placements.size() == 1)
+                _database->undoStack->push(new AddSceneObject(model, placements.front().first, placements.front().second));
+            else if(!placements.empty())
+                _database->undoStack->push(new AddSceneObjects(model, placements));
+            for (auto traj : trajectories)
+                traj->updateAttached();
         }
     };
 
@@ -174,7 +188,7 @@ void ContentManager::apply(vsg::ButtonPressEvent &buttonPress)
                 _database->undoStack->push(new RemoveFwdSignal(isection.connector, _database->topology));
         } else if(!isection.objects.empty())
         {
-            auto index = _database->tilesModel->index(isection.objects.front());
+            auto index = _database->tilesModel->reveal(isection.objects.front());
             if(index.isValid())
                 _database->undoStack->push(new RemoveNode(_database->tilesModel, index));
         }
@@ -8,6 +8,7 @@
 #include "undo-redo.h"
 #include "topology.h"
 #include <QRegularExpression>
+#include <QDir>
 
 DatabaseManager::DatabaseManager(vsg::ref_ptr<route::Route> in_route, vsg::ref_ptr<vsg::Options> options)
   : root(vsg::Group::create())
@@ -26,7 +27,37 @@ DatabaseManager::DatabaseManager(vsg::ref_ptr<route::Route> in_route, vsg::ref_p
     LambdaVisitor<decltype (fixPaths), vsg::PagedLOD> fp(fixPaths);
     in_route->plods->accept(fp);
 
+    registry = ObjectRegistry::create();
+    registry->addTree(route);
+
+    nameIndex = NameIndex::create();
+    nameIndex->build(*registry);
+
+    facetIndex = FacetIndex::create(registry);
+    facetIndex->build();
+
     tilesModel = new SceneModel(route, builder);
+    tilesModel->setRegistry(registry);
+    tilesModel->setNameIndex(nameIndex);
+    tilesModel->setFacetIndex(facetIndex);
+
+    spatialIndex = SpatialIndex::create(tilesModel->getRoot());
+    picker = Picker::create(root, std::vector<const vsg::Node*>{root.get(), route.get(), route->tiles.get()});
+
+    auto invalidate = [index=spatialIndex.get(), picker=picker.get()]()
+    {
+        index->invalidate();
+        picker->invalidate();
+    };
+    //inserted rows are mostly fetched ones, which are in the scene already, added objects come with the change set
+    QObject::connect(tilesModel, &QAbstractItemModel::rowsRemoved, tilesModel, invalidate);
+    QObject::connect(tilesModel, &QAbstractItemModel::modelReset, tilesModel, invalidate);
+    //renames do not move anything
+    QObject::connect(tilesModel, &SceneModel::changed, tilesModel, [invalidate](const ChangeSet &changes)
+    {
+        if(changes.other || !changes.transformed.empty() || !changes.added.empty() || !changes.removed.empty())
+            invalidate();
+    });
 }
 DatabaseManager::~DatabaseManager()
 {
@@ -51,6 +82,7 @@ void DatabaseManager::setViewer(vsg::ref_ptr<vsg::Viewer> viewer)
     _stdWireBox = builder->createBox(gi, si);
 
     builder->options->setObject(app::WIREFRAME, _stdWireBox);
+    picker->addGizmo(_stdWireBox);
 
     _stdAxis = vsg::Group::create();
 
@@ -69,6 +101,7 @@ void DatabaseManager::setViewer(vsg::ref_ptr<vsg::Viewer> viewer)
     gi.dz = vsg::vec3(0.0f, 0.0f, 1.0f);
     gi.color = vsg::vec4(0.0f, 0.0f, 1.0f, 1.0f);
     _stdAxis->addChild(builder->createBox(gi));
+    picker->addGizmo(_stdAxis);
 }
 
 vsg::ref_ptr<vsg::Node> DatabaseManager::getStdWireBox()
@@ -114,9 +147,42 @@ void DatabaseManager::writeTiles()
 
     std::for_each(std::execution::par, route->tiles->childrenObjects().begin(), route->tiles->childrenObjects().end(), write);
 
+    writeHistory();
     undoStack->setClean();
 }
 
+void DatabaseManager::writeHistory()
+{
+    UndoHistory::save(historyPath(), UndoHistory::revision(filePaths()), undoStack, *registry);
+}
+
+bool DatabaseManager::readHistory()
+{
+    return UndoHistory::restore(historyPath(), UndoHistory::revision(filePaths()), undoStack, tilesModel, *registry);
+}
+
+QString DatabaseManager::historyPath() const
+{
+    std::string path;
+    route->getValue(app::PATH, path);
+    QFileInfo info(QString::fromStdString(path));
+    return info.dir().filePath(info.completeBaseName() + ".undo");
+}
+
+std::vector<std::string> DatabaseManager::filePaths() const
+{
+    std::vector<std::string> paths;
+    std::string path;
+    if(route->getValue(app::PATH, path))
+        paths.push_back(path);
+    for (const auto &tile : route->tiles->childrenObjects())
+    {
+        if(tile->getValue(app::PATH, path))
+            paths.push_back(path);
+    }
+    return paths;
+}
+
 void DatabaseManager::compile()
 {
     Q_ASSERT(viewer);
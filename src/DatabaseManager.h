@@ -6,6 +6,11 @@
 #include <QFileSystemWatcher>
 #include <QException>
 #include "SceneObjectsModel.h"
+#include "SpatialIndex.h"
+#include "ObjectRegistry.h"
+#include "NameIndex.h"
+#include "FacetIndex.h"
+#include "Picker.h"
 #include "route.h"
 #include <QSettings>
 #include <QProgressBar>
@@ -59,9 +64,23 @@ public:
 
     SceneModel *tilesModel;
 
+    vsg::ref_ptr<ObjectRegistry> registry;
+    vsg::ref_ptr<NameIndex> nameIndex;
+    vsg::ref_ptr<FacetIndex> facetIndex;
+
+    vsg::ref_ptr<SpatialIndex> spatialIndex;
+    vsg::ref_ptr<Picker> picker;
+
     void writeTiles();
 
+    //undo history next to the route, valid for the tile files it has been saved with
+    void writeHistory();
+    bool readHistory();
+
 private:
+    QString historyPath() const;
+    std::vector<std::string> filePaths() const;
+
     void compile();
     bool _compiled = false;
 
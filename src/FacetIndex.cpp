@@ -0,0 +1,157 @@
+#include "FacetIndex.h"
+#include "tile.h"
+#include <algorithm>
+
+FacetIndex::FacetIndex(vsg::ref_ptr<ObjectRegistry> registry)
+    : _registry(registry)
+{
+}
+
+void FacetIndex::build()
+{
+    _classes.clear();
+    _assets.clear();
+    _tiles.clear();
+    _keys.clear();
+
+    for (uint32_t slot = 0; slot < _registry->slotCount(); ++slot)
+    {
+        if(auto object = _registry->object(_registry->slotId(slot)); object)
+            add(object);
+    }
+}
+
+void FacetIndex::add(const route::MVCObject *object)
+{
+    auto slot = _registry->slot(object);
+    if(slot == ObjectRegistry::NULL_SLOT)
+        return;
+    if(slot >= _keys.size())
+        _keys.resize(slot + 1);
+    else if(_keys[slot].present)
+        remove(object);
+
+    auto &keys = _keys[slot];
+    keys.present = true;
+    keys.className = QString::fromLatin1(object->className());
+
+    std::string asset;
+    keys.asset = object->getValue(ASSET_KEY, asset) ? QString::fromStdString(asset) : QString();
+
+    keys.tile = ObjectRegistry::NULL_ID;
+    for (auto node = object; node; node = node->parent())
+    {
+        if(node->is_compatible(typeid(route::Tile)))
+        {
+            keys.tile = _registry->id(node);
+            break;
+        }
+    }
+
+    assign(_classes, keys.className, slot, true);
+    if(!keys.asset.isEmpty())
+        assign(_assets, keys.asset, slot, true);
+    if(keys.tile != ObjectRegistry::NULL_ID)
+        assign(_tiles, keys.tile, slot, true);
+}
+
+void FacetIndex::remove(const route::MVCObject *object)
+{
+    auto slot = _registry->slot(object);
+    if(slot >= _keys.size() || !_keys[slot].present)
+        return;
+
+    auto &keys = _keys[slot];
+    assign(_classes, keys.className, slot, false);
+    if(!keys.asset.isEmpty())
+        assign(_assets, keys.asset, slot, false);
+    if(keys.tile != ObjectRegistry::NULL_ID)
+        assign(_tiles, keys.tile, slot, false);
+    keys = {};
+}
+
+QStringList FacetIndex::classes() const
+{
+    QStringList result;
+    for (const auto &[name, bits] : _classes)
+        result.push_back(name);
+    return result;
+}
+
+QStringList FacetIndex::assets() const
+{
+    QStringList result;
+    for (const auto &[name, bits] : _assets)
+        result.push_back(name);
+    return result;
+}
+
+std::vector<ObjectRegistry::ID> FacetIndex::tiles() const
+{
+    std::vector<ObjectRegistry::ID> result;
+    for (const auto &[id, bits] : _tiles)
+        result.push_back(id);
+    return result;
+}
+
+FacetIndex::Bits FacetIndex::select(const Query &query) const
+{
+    auto words = (_registry->slotCount() + 63) / 64;
+    Bits result(words, ~uint64_t(0));
+
+    auto intersect = [&result](const Bits &bits)
+    {
+        for (size_t i = 0; i < result.size(); ++i)
+            result[i] &= i < bits.size() ? bits[i] : 0;
+    };
+
+    if(!query.classes.empty())
+        intersect(any(_classes, std::vector<QString>(query.classes.begin(), query.classes.end())));
+    if(!query.assets.empty())
+        intersect(any(_assets, std::vector<QString>(query.assets.begin(), query.assets.end())));
+    if(!query.tiles.empty())
+        intersect(any(_tiles, query.tiles));
+
+    return result;
+}
+
+bool FacetIndex::matches(const Query &query, uint32_t slot) const
+{
+    if(query.empty())
+        return true;
+    if(slot >= _keys.size() || !_keys[slot].present)
+        return false;
+
+    const auto &keys = _keys[slot];
+    return (query.classes.empty() || query.classes.contains(keys.className)) &&
+           (query.assets.empty() || query.assets.contains(keys.asset)) &&
+           (query.tiles.empty() || std::find(query.tiles.begin(), query.tiles.end(), keys.tile) != query.tiles.end());
+}
+
+template<typename K>
+void FacetIndex::assign(std::map<K, Bits> &facet, const K &key, uint32_t slot, bool value)
+{
+    auto &bits = facet[key];
+    if(slot / 64 >= bits.size())
+        bits.resize(slot / 64 + 1, 0);
+    if(value)
+        bits[slot / 64] |= uint64_t(1) << (slot % 64);
+    else
+        bits[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+}
+
+template<typename K>
+FacetIndex::Bits FacetIndex::any(const std::map<K, Bits> &facet, const std::vector<K> &keys) const
+{
+    Bits result((_registry->slotCount() + 63) / 64, 0);
+    for (const auto &key : keys)
+    {
+        auto it = facet.find(key);
+        if(it == facet.end())
+            continue;
+        const auto &bits = it->second;
+        for (size_t i = 0; i < bits.size() && i < result.size(); ++i)
+            result[i] |= bits[i];
+    }
+    return result;
+}
@@ -0,0 +1,69 @@
+#ifndef FACETINDEX_H
+#define FACETINDEX_H
+
+#include "ObjectRegistry.h"
+#include <QStringList>
+#include <map>
+
+//Per-class, per-asset and per-tile bitsets over registry slots.
+class FacetIndex : public vsg::Inherit<vsg::Object, FacetIndex>
+{
+public:
+    using Bits = std::vector<uint64_t>;
+
+    //path of the model file an object has been placed from, relative to the content root
+    static constexpr const char *ASSET_KEY = "asset";
+
+    //empty lists do not constrain, values within one list are alternatives
+    struct Query
+    {
+        QStringList classes;
+        QStringList assets;
+        std::vector<ObjectRegistry::ID> tiles;
+
+        bool empty() const { return classes.empty() && assets.empty() && tiles.empty(); }
+    };
+
+    explicit FacetIndex(vsg::ref_ptr<ObjectRegistry> registry);
+
+    void build();
+
+    void add(const route::MVCObject *object);
+    void remove(const route::MVCObject *object);
+
+    QStringList classes() const;
+    QStringList assets() const;
+    std::vector<ObjectRegistry::ID> tiles() const;
+
+    Bits select(const Query &query) const;
+    bool matches(const Query &query, uint32_t slot) const;
+
+    static bool test(const Bits &bits, uint32_t slot)
+    {
+        return slot / 64 < bits.size() && (bits[slot / 64] >> (slot % 64) & 1) != 0;
+    }
+
+private:
+    struct Keys
+    {
+        bool present = false;
+        QString className;
+        QString asset;
+        ObjectRegistry::ID tile = ObjectRegistry::NULL_ID;
+    };
+
+    template<typename K>
+    static void assign(std::map<K, Bits> &facet, const K &key, uint32_t slot, bool value);
+    template<typename K>
+    Bits any(const std::map<K, Bits> &facet, const std::vector<K> &keys) const;
+
+    vsg::ref_ptr<ObjectRegistry> _registry;
+
+    std::map<QString, Bits> _classes;
+    std::map<QString, Bits> _assets;
+    std::map<ObjectRegistry::ID, Bits> _tiles;
+
+    std::vector<Keys> _keys;
+};
+
+#endif // FACETINDEX_H
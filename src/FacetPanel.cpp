@@ -0,0 +1,102 @@
+#include "FacetPanel.h"
+#include <QLabel>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QSet>
+
+FacetPanel::FacetPanel(vsg::ref_ptr<ObjectRegistry> registry, vsg::ref_ptr<FacetIndex> facets, QWidget *parent) : QWidget(parent)
+  , _registry(registry)
+  , _facets(facets)
+  , _classes(new QListWidget(this))
+  , _assets(new QListWidget(this))
+  , _tiles(new QListWidget(this))
+{
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(new QLabel(tr("Типы"), this));
+    layout->addWidget(_classes);
+    layout->addWidget(new QLabel(tr("Модели"), this));
+    layout->addWidget(_assets);
+    layout->addWidget(new QLabel(tr("Тайлы"), this));
+    layout->addWidget(_tiles);
+
+    auto buttons = new QHBoxLayout();
+    auto refreshButt = new QPushButton(tr("Обновить"), this);
+    auto resetButt = new QPushButton(tr("Сбросить"), this);
+    buttons->addWidget(refreshButt);
+    buttons->addWidget(resetButt);
+    layout->addLayout(buttons);
+
+    connect(refreshButt, &QPushButton::pressed, this, &FacetPanel::refresh);
+    connect(resetButt, &QPushButton::pressed, this, &FacetPanel::reset);
+    for (auto list : {_classes, _assets, _tiles})
+        connect(list, &QListWidget::itemChanged, this, &FacetPanel::emitQuery);
+
+    refresh();
+}
+
+void FacetPanel::refresh()
+{
+    //keeps checked values that are still present
+    auto fill = [](QListWidget *list, const QStringList &names, const QList<QVariant> &data)
+    {
+        QSet<QString> checked;
+        for (int i = 0; i < list->count(); ++i)
+            if(list->item(i)->checkState() == Qt::Checked)
+                checked.insert(list->item(i)->data(Qt::UserRole).toString());
+
+        QSignalBlocker blocker(list);
+        list->clear();
+        for (int i = 0; i < names.size(); ++i)
+        {
+            auto item = new QListWidgetItem(names[i], list);
+            item->setData(Qt::UserRole, data[i]);
+            item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+            item->setCheckState(checked.contains(data[i].toString()) ? Qt::Checked : Qt::Unchecked);
+        }
+    };
+
+    auto classes = _facets->classes();
+    fill(_classes, classes, {classes.begin(), classes.end()});
+
+    auto assets = _facets->assets();
+    fill(_assets, assets, {assets.begin(), assets.end()});
+
+    QStringList tileNames;
+    QList<QVariant> tileIds;
+    for (auto id : _facets->tiles())
+    {
+        auto tile = _registry->object(id);
+        tileNames.push_back(tile ? tile->getName() : QString::number(id));
+        tileIds.push_back(QVariant::fromValue<qulonglong>(id));
+    }
+    fill(_tiles, tileNames, tileIds);
+
+    emitQuery();
+}
+
+void FacetPanel::reset()
+{
+    for (auto list : {_classes, _assets, _tiles})
+    {
+        QSignalBlocker blocker(list);
+        for (int i = 0; i < list->count(); ++i)
+            list->item(i)->setCheckState(Qt::Unchecked);
+    }
+    emitQuery();
+}
+
+void FacetPanel::emitQuery()
+{
+    FacetIndex::Query query;
+    for (int i = 0; i < _classes->count(); ++i)
+        if(_classes->item(i)->checkState() == Qt::Checked)
+            query.classes.push_back(_classes->item(i)->data(Qt::UserRole).toString());
+    for (int i = 0; i < _assets->count(); ++i)
+        if(_assets->item(i)->checkState() == Qt::Checked)
+            query.assets.push_back(_assets->item(i)->data(Qt::UserRole).toString());
+    for (int i = 0; i < _tiles->count(); ++i)
+        if(_tiles->item(i)->checkState() == Qt::Checked)
+            query.tiles.push_back(_tiles->item(i)->data(Qt::UserRole).toULongLong());
+    emit queryChanged(query);
+}
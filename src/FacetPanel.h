@@ -0,0 +1,32 @@
+#ifndef FACETPANEL_H
+#define FACETPANEL_H
+
+#include <QWidget>
+#include <QListWidget>
+#include "FacetIndex.h"
+
+class FacetPanel : public QWidget
+{
+    Q_OBJECT
+public:
+    FacetPanel(vsg::ref_ptr<ObjectRegistry> registry, vsg::ref_ptr<FacetIndex> facets, QWidget *parent = nullptr);
+
+public slots:
+    void refresh();
+    void reset();
+
+signals:
+    void queryChanged(const FacetIndex::Query &query);
+
+private:
+    void emitQuery();
+
+    vsg::ref_ptr<ObjectRegistry> _registry;
+    vsg::ref_ptr<FacetIndex> _facets;
+
+    QListWidget *_classes;
+    QListWidget *_assets;
+    QListWidget *_tiles;
+};
+
+#endif // FACETPANEL_H
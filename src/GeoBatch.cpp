@@ -0,0 +1,156 @@
+#include "GeoBatch.h"
+#include <cmath>
+
+//The loops below call no library functions, so that the compiler can turn them into SIMD code.
+//Sine, cosine and arctangent are branch-free polynomials, accurate to a few units in the last place.
+namespace
+{
+    //rounds to the nearest integer for |x| < 2^51 without a library call
+    inline double roundNearest(double x)
+    {
+        constexpr double magic = 6755399441055744.0; //1.5 * 2^52
+        return (x + magic) - magic;
+    }
+
+    //fdlibm kernels on [-pi/4, pi/4]
+    inline double sinKernel(double x)
+    {
+        auto z = x * x;
+        return x + x * z * (-1.66666666666666324348e-01 + z * (8.33333333332248946124e-03 + z * (-1.98412698298579493134e-04
+                   + z * (2.75573137070700676789e-06 + z * (-2.50507602534068634195e-08 + z * 1.58969099521155010221e-10)))));
+    }
+
+    inline double cosKernel(double x)
+    {
+        auto z = x * x;
+        return 1.0 - 0.5 * z + z * z * (4.16666666666666019037e-02 + z * (-1.38888888888741095749e-03 + z * (2.48015872894767294178e-05
+                   + z * (-2.75573143513906633035e-07 + z * (2.08757232129817482790e-09 + z * -1.13596475577881948265e-11)))));
+    }
+
+    //arguments up to a few turns, pi/2 is split in three parts so that the reduction stays exact
+    inline void sinCos(double x, double &s, double &c)
+    {
+        auto q = roundNearest(x * 0.63661977236758134308);
+        auto r = x - q * 1.57079632673412561417e+00;
+        r -= q * 6.07710050630396597660e-11;
+        r -= q * 2.02226624871116645580e-21;
+
+        auto quadrant = static_cast<int>(q) & 3;
+        auto sr = sinKernel(r);
+        auto cr = cosKernel(r);
+        auto swapped = (quadrant & 1) != 0;
+        auto sv = swapped ? cr : sr;
+        auto cv = swapped ? sr : cr;
+        s = (quadrant & 2) != 0 ? -sv : sv;
+        c = ((quadrant + 1) & 2) != 0 ? -cv : cv;
+    }
+
+    //Cephes atan on [0, 1], arguments above tan(pi/8) are reduced by pi/4
+    inline double atanUnit(double t)
+    {
+        constexpr double tanPi8 = 0.41421356237309504880;
+        constexpr double moreBits = 6.123233995736765886130e-17;
+
+        //both sides are computed, a select vectorises where a branch would not
+        auto reduced = t > tanPi8;
+        auto shifted = (t - 1.0) / (t + 1.0);
+        auto x = reduced ? shifted : t;
+        auto z = x * x;
+        auto p = (((-8.750608600031904122785e-1 * z - 1.615753718733365076637e1) * z - 7.500855792314704667340e1) * z
+                  - 1.228866684490136173410e2) * z - 6.485021904942025371773e1;
+        auto q = ((((z + 2.485846490142306297962e1) * z + 1.650270098316988542046e2) * z + 4.328810604912902668951e2) * z
+                  + 4.853903996359136964868e2) * z + 1.945506571482613964425e2;
+        auto y = x + x * z * p / q;
+        return reduced ? y + (vsg::PI / 4 + 0.5 * moreBits) : y;
+    }
+
+    inline double atan2Fast(double y, double x)
+    {
+        auto ax = std::fabs(x);
+        auto ay = std::fabs(y);
+        auto steep = ay > ax;
+        auto numerator = steep ? ax : ay;
+        auto denominator = steep ? ay : ax;
+        //0 / 0 at the origin, where atan2 gives 0 too
+        auto r = atanUnit(numerator / (denominator > 0.0 ? denominator : 1.0));
+        r = steep ? vsg::PI / 2 - r : r;
+        r = x < 0.0 ? vsg::PI - r : r;
+        return std::copysign(r, y);
+    }
+}
+
+GeoBatch::GeoBatch(const vsg::EllipsoidModel &model)
+    : _equator(model.radiusEquator())
+    , _polar(model.radiusPolar())
+{
+    auto a2 = _equator * _equator;
+    auto b2 = _polar * _polar;
+    _e2 = (a2 - b2) / a2;
+    _ep2 = (a2 - b2) / b2;
+}
+
+void GeoBatch::toLatLongAltitude(const CoordinateArrays &ecef, CoordinateArrays &lla) const
+{
+    auto count = ecef.size();
+    lla.resize(count);
+
+    const double *x = ecef.x.data();
+    const double *y = ecef.y.data();
+    const double *z = ecef.z.data();
+    double *lat = lla.x.data();
+    double *lon = lla.y.data();
+    double *alt = lla.z.data();
+
+    const auto a = _equator;
+    const auto b = _polar;
+    const auto e2 = _e2;
+    const auto ep2 = _ep2;
+    constexpr double degrees = 180.0 / vsg::PI;
+
+    //Bowring's closed form, as in EllipsoidModel
+#pragma omp simd
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto p = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+        double st, ct;
+        sinCos(atan2Fast(z[i] * a, p * b), st, ct);
+        auto phi = atan2Fast(z[i] + ep2 * b * st * st * st, p - e2 * a * ct * ct * ct);
+        double sp, cp;
+        sinCos(phi, sp, cp);
+
+        lat[i] = phi * degrees;
+        lon[i] = atan2Fast(y[i], x[i]) * degrees;
+        //stays finite at the poles, unlike p / cos(phi) - N
+        alt[i] = p * cp + z[i] * sp - a * std::sqrt(1.0 - e2 * sp * sp);
+    }
+}
+
+void GeoBatch::toECEF(const CoordinateArrays &lla, CoordinateArrays &ecef) const
+{
+    auto count = lla.size();
+    ecef.resize(count);
+
+    const double *lat = lla.x.data();
+    const double *lon = lla.y.data();
+    const double *alt = lla.z.data();
+    double *x = ecef.x.data();
+    double *y = ecef.y.data();
+    double *z = ecef.z.data();
+
+    const auto a = _equator;
+    const auto e2 = _e2;
+    constexpr double radians = vsg::PI / 180.0;
+
+#pragma omp simd
+    for (size_t i = 0; i < count; ++i)
+    {
+        double sp, cp, sl, cl;
+        sinCos(lat[i] * radians, sp, cp);
+        sinCos(lon[i] * radians, sl, cl);
+        auto n = a / std::sqrt(1.0 - e2 * sp * sp);
+
+        x[i] = (n + alt[i]) * cp * cl;
+        y[i] = (n + alt[i]) * cp * sl;
+        z[i] = (n * (1.0 - e2) + alt[i]) * sp;
+    }
+}
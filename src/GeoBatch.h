@@ -0,0 +1,50 @@
+#ifndef GEOBATCH_H
+#define GEOBATCH_H
+
+#include <vsg/app/EllipsoidModel.h>
+#include <vector>
+
+//Positions as separate coordinate arrays, either ECEF in metres or latitude, longitude in degrees and altitude in metres
+struct CoordinateArrays
+{
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+
+    size_t size() const { return x.size(); }
+    void resize(size_t count)
+    {
+        x.resize(count);
+        y.resize(count);
+        z.resize(count);
+    }
+    void set(size_t i, const vsg::dvec3 &v)
+    {
+        x[i] = v.x;
+        y[i] = v.y;
+        z[i] = v.z;
+    }
+    vsg::dvec3 get(size_t i) const { return {x[i], y[i], z[i]}; }
+};
+
+//Converts many positions between ECEF and latitude/longitude/altitude on the ellipsoid of the route.
+//The same Bowring closed form as EllipsoidModel, with polynomial sine, cosine and arctangent instead of library calls,
+//so the loops over the arrays compile to SIMD code. Below 10 km altitude the results stay within a micrometre
+//of the scalar ones, geo_bench prints the largest difference and both timings.
+class GeoBatch
+{
+public:
+    explicit GeoBatch(const vsg::EllipsoidModel &model);
+
+    void toLatLongAltitude(const CoordinateArrays &ecef, CoordinateArrays &lla) const;
+    void toECEF(const CoordinateArrays &lla, CoordinateArrays &ecef) const;
+
+private:
+    double _equator;
+    double _polar;
+    //first and second eccentricity squared
+    double _e2;
+    double _ep2;
+};
+
+#endif // GEOBATCH_H
@@ -0,0 +1,92 @@
+#include "GroupTransform.h"
+#include "tools.h"
+#include <QtGlobal>
+#include <unordered_map>
+
+GroupTransform::GroupTransform(const ObjectRegistry &registry, const std::vector<ObjectRegistry::ID> &ids)
+{
+    std::unordered_map<const route::MVCObject*, uint32_t> parents;
+    _objectFrames.reserve(ids.size());
+    _world.reserve(ids.size());
+
+    for (auto id : ids)
+    {
+        auto object = registry.object(id);
+        const route::MVCObject *parent = object ? object->parent() : nullptr;
+
+        auto [it, inserted] = parents.emplace(parent, static_cast<uint32_t>(_frames.size()));
+        if(inserted)
+        {
+            Frame frame;
+            if(parent)
+            {
+                frame.localToWorld = parent->getWorldTransform();
+                frame.worldToLocal = vsg::inverse(frame.localToWorld);
+                vsg::dvec3 translation, scale;
+                vsg::decompose(frame.localToWorld, translation, frame.rotation, scale);
+            }
+            _frames.push_back(frame);
+        }
+        _objectFrames.push_back(it->second);
+
+        auto world = _frames[it->second].localToWorld * (object ? object->getPosition() : vsg::dvec3());
+        _world.push_back(world);
+        if(object)
+        {
+            _bounds.add(world);
+            _sum += world;
+            ++_count;
+        }
+    }
+}
+
+void GroupTransform::toLocal(std::vector<vsg::dvec3> &positions) const
+{
+    Q_ASSERT(positions.size() == _objectFrames.size());
+    for (size_t i = 0; i < _objectFrames.size(); ++i)
+        positions[i] = _frames[_objectFrames[i]].worldToLocal * positions[i];
+}
+
+vsg::dvec3 GroupTransform::center() const
+{
+    return _bounds.valid() ? (_bounds.min + _bounds.max) * 0.5 : vsg::dvec3();
+}
+
+vsg::dvec3 GroupTransform::centroid() const
+{
+    return _count > 0 ? _sum / static_cast<double>(_count) : vsg::dvec3();
+}
+
+vsg::dmat4 GroupTransform::rotation(const vsg::dvec3 &pivot, const vsg::dquat &delta, size_t frame) const
+{
+    auto parent = frame < _objectFrames.size() ? _frames[_objectFrames[frame]].rotation : vsg::dquat();
+    auto world = parent * delta * tools::inverse(parent);
+    return vsg::translate(pivot) * vsg::rotate(world) * vsg::translate(-pivot);
+}
+
+void GroupTransform::apply(const vsg::dmat4 &world, std::vector<vsg::dvec3> &positions, std::vector<vsg::dquat> &rotations) const
+{
+    Q_ASSERT(positions.size() == _objectFrames.size() && rotations.size() == _objectFrames.size());
+
+    //the world matrix as seen from every parent, computed once per parent
+    std::vector<vsg::dmat4> matrices;
+    std::vector<vsg::dquat> turns;
+    matrices.reserve(_frames.size());
+    turns.reserve(_frames.size());
+    for (const auto &frame : _frames)
+    {
+        auto local = frame.worldToLocal * world * frame.localToWorld;
+        vsg::dvec3 translation, scale;
+        vsg::dquat rotation;
+        vsg::decompose(local, translation, rotation, scale);
+        matrices.push_back(local);
+        turns.push_back(vsg::normalize(rotation));
+    }
+
+    for (size_t i = 0; i < _objectFrames.size(); ++i)
+    {
+        auto frame = _objectFrames[i];
+        positions[i] = matrices[frame] * positions[i];
+        rotations[i] = turns[frame] * rotations[i];
+    }
+}
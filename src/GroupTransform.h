@@ -0,0 +1,51 @@
+#ifndef GROUPTRANSFORM_H
+#define GROUPTRANSFORM_H
+
+#include "ObjectRegistry.h"
+#include <vsg/maths/box.h>
+#include <vsg/maths/transform.h>
+
+//Rigid transform of a whole selection in world space.
+//Selected objects may sit under different tiles, a world matrix is brought into the frame of each parent once
+//and then applied to all objects of that parent.
+class GroupTransform
+{
+public:
+    GroupTransform(const ObjectRegistry &registry, const std::vector<ObjectRegistry::ID> &ids);
+
+    //world bounds of the object origins
+    const vsg::dbox &bounds() const { return _bounds; }
+    vsg::dvec3 center() const;
+    //mean of the object origins, unlike the center of the bounds it stays put under rotation about itself
+    vsg::dvec3 centroid() const;
+
+    //origins of the objects in world coordinates, parallel to the ids
+    const std::vector<vsg::dvec3> &worldPositions() const { return _world; }
+    //brings world positions parallel to the ids into the frames of their parents
+    void toLocal(std::vector<vsg::dvec3> &positions) const;
+
+    //rotation about the pivot, delta is given in the frame of the parent of the object at index frame
+    vsg::dmat4 rotation(const vsg::dvec3 &pivot, const vsg::dquat &delta, size_t frame = 0) const;
+
+    //transforms local positions and rotations parallel to the ids by the world matrix
+    void apply(const vsg::dmat4 &world, std::vector<vsg::dvec3> &positions, std::vector<vsg::dquat> &rotations) const;
+
+private:
+    struct Frame
+    {
+        vsg::dmat4 localToWorld;
+        vsg::dmat4 worldToLocal;
+        vsg::dquat rotation;
+    };
+
+    std::vector<Frame> _frames;
+    //frame of every object
+    std::vector<uint32_t> _objectFrames;
+    std::vector<vsg::dvec3> _world;
+
+    vsg::dbox _bounds;
+    vsg::dvec3 _sum;
+    size_t _count = 0;
+};
+
+#endif // GROUPTRANSFORM_H
@@ -6,6 +6,8 @@
 #include <QColorDialog>
 #include <QErrorMessage>
 #include <QMessageBox>
+#include <QClipboard>
+#include <QGuiApplication>
 #include "undo-redo.h"
 #include "InterlockDialog.h"
 #include "ContentManager.h"
@@ -27,33 +29,61 @@ MainWindow::MainWindow(vsg::ref_ptr<DatabaseManager> dbm, QWidget *parent)
 
     _database->setUndoStack(new QUndoStack(this));
 
+    {
+        QSettings settings(app::ORGANIZATION_NAME, app::APP_NAME);
+        //megabytes, 0 disables compaction
+        auto budget = settings.value("UNDOBUDGET", 512).toULongLong();
+        new UndoBudget(_database->undoStack, budget * 1024 * 1024, this);
+    }
+    if(_database->readHistory())
+        ui->statusbar->showMessage(tr("Восстановлена история действий"), 3000);
+
     initializeTools();
 
     _undoView = new QUndoView(_database->undoStack, ui->tabWidget);
     ui->tabWidget->addTab(_undoView, tr("Действия"));
 
+    _facetPanel = new FacetPanel(_database->registry, _database->facetIndex, ui->tabWidget);
+    ui->tabWidget->addTab(_facetPanel, tr("Фильтры"));
+    connect(_facetPanel, &FacetPanel::queryChanged, _sorter, &TilesSorter::setFacets);
+
+    ui->tabWidget->addTab(new ProfilerPanel(ui->tabWidget), tr("Профилирование"));
+
     connect(ui->actionUndo, &QAction::triggered, _database->undoStack, &QUndoStack::undo);
     connect(ui->actionRedo, &QAction::triggered, _database->undoStack, &QUndoStack::redo);
 
     connect(ui->actionSave, &QAction::triggered, this, [this](){ _database->writeTiles(); });
 
-    connect(ui->removeButt, &QPushButton::pressed, this, [this]()
+    connect(ui->actionCopy, &QAction::triggered, this, [this]()
     {
         auto selected = _sorter->mapSelectionToSource(ui->tilesView->selectionModel()->selection()).indexes();
-        if(!selected.empty())
+        if(auto data = _database->tilesModel->copyData(selected); data)
+            QGuiApplication::clipboard()->setMimeData(data);
+        else
+            ui->statusbar->showMessage(tr("Выберите объекты, которые нужно скопировать"), 3000);
+    });
+    connect(ui->actionPaste, &QAction::triggered, this, [this]()
+    {
+        auto selected = _sorter->mapSelectionToSource(ui->tilesView->selectionModel()->selection()).indexes();
+        if(selected.empty())
         {
-            if(selected.size() > 1)
-            {
-                std::sort(selected.begin(), selected.end(), [](auto lhs, auto rhs){ return lhs.row() > rhs.row(); });
-                _database->undoStack->beginMacro("Удалены объекты");
-            }
-
-            for (const auto &index : selected)
-                    _database->undoStack->push(new RemoveNode(_database->tilesModel, index));
-
-            if(selected.size() > 1)
-                _database->undoStack->endMacro();
+            ui->statusbar->showMessage(tr("Выберите группу для вставки"), 3000);
+            return;
         }
+        auto group = selected.front();
+        if(!_database->tilesModel->canAdd(group))
+            group = group.parent();
+        if(!_database->tilesModel->dropMimeData(QGuiApplication::clipboard()->mimeData(), Qt::CopyAction, -1, 0, group))
+            ui->statusbar->showMessage(tr("Не удалось вставить объекты"), 3000);
+    });
+
+    connect(ui->removeButt, &QPushButton::pressed, this, [this]()
+    {
+        auto selected = _sorter->mapSelectionToSource(ui->tilesView->selectionModel()->selection()).indexes();
+        if(selected.size() == 1)
+            _database->undoStack->push(new RemoveNode(_database->tilesModel, selected.front()));
+        else if(!selected.empty())
+            _database->undoStack->push(new RemoveNodes(_database->tilesModel, selected));
         else
             ui->statusbar->showMessage(tr("Выберите объекты, которые нужно удалить"), 3000);
     });
@@ -65,12 +95,8 @@ MainWindow::MainWindow(vsg::ref_ptr<DatabaseManager> dbm, QWidget *parent)
             _database->undoStack->beginMacro(tr("Создан слой"));
             auto group = route::SceneGroup::create();
             auto parent = selected.front().parent();
-            for (const auto &index : selected)
-            {
-                Q_ASSERT(index.isValid());
-                //group->childrenObjects().emplace_back(static_cast<route::MVCObject*>(index.internalPointer()));
-                _database->undoStack->push(new RemoveNode(_database->tilesModel, index));
-            }
+            //group->childrenObjects().emplace_back(static_cast<route::MVCObject*>(index.internalPointer()));
+            _database->undoStack->push(new RemoveNodes(_database->tilesModel, selected));
             _database->undoStack->push(new AddSceneObject(_database->tilesModel, parent, group));
             _database->undoStack->endMacro();
         }
@@ -158,6 +184,8 @@ void MainWindow::initializeTools()
 
     connect(_sorter, &TilesSorter::selectionChanged, _objectsPrpEditor, &ObjectPropertiesEditor::selectIndex);
     connect(_objectsPrpEditor, &ObjectPropertiesEditor::objectClicked, _sorter, &TilesSorter::select);
+    connect(_objectsPrpEditor, &ObjectPropertiesEditor::objectsSelected, _sorter, &TilesSorter::selectBatch);
+    connect(_objectsPrpEditor, &ObjectPropertiesEditor::objectsDeselected, _sorter, &TilesSorter::deselectBatch);
     connect(_objectsPrpEditor, &ObjectPropertiesEditor::deselect, ui->tilesView->selectionModel(), &QItemSelectionModel::clear);
     connect(_objectsPrpEditor, &ObjectPropertiesEditor::deselectItem, _sorter, &TilesSorter::deselect);
     connect(_contentManager, &ContentManager::sendObject, _objectsPrpEditor, &ObjectPropertiesEditor::selectObject);
@@ -345,15 +373,18 @@ void MainWindow::constructWidgets()
 
     _sorter = new TilesSorter(this);
     _sorter->setSourceModel(_database->tilesModel);
+    _sorter->setIndices(_database->registry, _database->nameIndex, _database->facetIndex);
     _sorter->setFilterKeyColumn(1);
-    _sorter->setFilterWildcard("*");
+    _sorter->setPattern("*");
     ui->tilesView->setModel(_sorter);
 
-    connect(ui->lineEdit, &QLineEdit::textChanged, _sorter, &TilesSorter::setFilterWildcard);
+    connect(ui->lineEdit, &QLineEdit::textChanged, _sorter, &TilesSorter::setPattern);
     connect(ui->tilesView->selectionModel(), &QItemSelectionModel::selectionChanged, _sorter, &TilesSorter::viewSelectSlot);
     connect(ui->tilesView, &QTreeView::doubleClicked, _sorter, &TilesSorter::viewDoubleClicked);
     connect(_sorter, &TilesSorter::viewSelectSignal, ui->tilesView->selectionModel(),
              qOverload<const QModelIndex &, QItemSelectionModel::SelectionFlags>(&QItemSelectionModel::select));
+    connect(_sorter, &TilesSorter::viewSelectionSignal, ui->tilesView->selectionModel(),
+             qOverload<const QItemSelection &, QItemSelectionModel::SelectionFlags>(&QItemSelectionModel::select));
     connect(_sorter, &TilesSorter::viewExpandSignal, ui->tilesView, &QTreeView::expand);
 
     ui->centralsplitter->addWidget(_embedded);
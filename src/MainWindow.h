@@ -13,6 +13,8 @@
 #include <vsg/all.h>
 #include <QToolBox>
 #include "TilesSorter.h"
+#include "FacetPanel.h"
+#include "ProfilerPanel.h"
 #include "ObjectPropertiesEditor.h"
 #include "RailsPointEditor.h"
 #include "AddRails.h"
@@ -53,5 +55,6 @@ private:
     TilesSorter *_sorter;
     QToolBox *_toolbox;
     QUndoView *_undoView;
+    FacetPanel *_facetPanel;
 
 };
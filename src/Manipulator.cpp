@@ -20,6 +20,7 @@ Manipulator::Manipulator(vsg::ref_ptr<vsg::Camera> camera,
 
     createPointer();
     manager->root->addChild(_pointer);
+    manager->picker->addGizmo(_pointer);
 }
 Manipulator::~Manipulator()
 {
@@ -74,7 +75,7 @@ void Manipulator::apply(vsg::ButtonPressEvent& buttonPress)
     {
         _updateMode = INACTIVE;
 
-        auto isections = route::testIntersections(buttonPress, _database->root, _camera);
+        auto isections = _database->picker->intersect(buttonPress, *_camera);
         if(isections.empty())
             return;
 
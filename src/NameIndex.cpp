@@ -0,0 +1,257 @@
+#include "NameIndex.h"
+#include <QRegularExpression>
+#include <algorithm>
+
+void NameIndex::build(const ObjectRegistry &registry)
+{
+    std::unique_lock lock(_mutex);
+
+    _names.clear();
+    _present.clear();
+    _postings.clear();
+    _unsorted.clear();
+    _entries = 0;
+    _stale = 0;
+
+    for (uint32_t slot = 0; slot < registry.slotCount(); ++slot)
+    {
+        if(auto object = registry.object(registry.slotId(slot)); object)
+        {
+            _names.resize(slot + 1);
+            _present.resize(slot + 1, false);
+            _names[slot] = object->getName();
+            _present[slot] = true;
+            insert(slot, _names[slot]);
+        }
+    }
+}
+
+void NameIndex::set(uint32_t slot, const QString &name)
+{
+    if(slot == ObjectRegistry::NULL_SLOT)
+        return;
+
+    std::unique_lock lock(_mutex);
+    if(slot >= _names.size())
+    {
+        _names.resize(slot + 1);
+        _present.resize(slot + 1, false);
+    }
+    else if(_present[slot])
+    {
+        if(_names[slot] == name)
+            return;
+        _stale += trigrams(_names[slot]).size();
+    }
+
+    _names[slot] = name;
+    _present[slot] = true;
+    insert(slot, name);
+
+    if(_stale > 1024 && _stale > _entries / 2)
+        compact();
+}
+
+void NameIndex::remove(uint32_t slot)
+{
+    std::unique_lock lock(_mutex);
+    if(slot >= _names.size() || !_present[slot])
+        return;
+    _stale += trigrams(_names[slot]).size();
+    _present[slot] = false;
+    _names[slot].clear();
+}
+
+void NameIndex::prepare()
+{
+    std::unique_lock lock(_mutex);
+    for (auto key : _unsorted)
+    {
+        auto &posting = _postings[key];
+        std::sort(posting.begin(), posting.end());
+        posting.erase(std::unique(posting.begin(), posting.end()), posting.end());
+    }
+    _unsorted.clear();
+}
+
+std::vector<uint32_t> NameIndex::match(const QString &wildcard, Qt::CaseSensitivity cs, const std::function<bool()> &cancelled) const
+{
+    constexpr uint32_t CANCEL_CHECK = 4096;
+
+    //the lock is held only while postings and names are copied, so that edits on the GUI thread do not wait for a query
+    std::vector<uint32_t> result;
+
+    auto parts = literals(wildcard);
+    bool anything = parts.empty() && !wildcard.contains('?') && !wildcard.contains('[');
+    if(anything)
+    {
+        std::vector<bool> present;
+        {
+            std::shared_lock lock(_mutex);
+            present = _present;
+        }
+        for (uint32_t slot = 0; slot < present.size(); ++slot)
+        {
+            if(slot % CANCEL_CHECK == 0 && cancelled && cancelled())
+                return {};
+            if(present[slot])
+                result.push_back(slot);
+        }
+        return result;
+    }
+
+    std::vector<Trigram> keys;
+    for (const auto &part : parts)
+    {
+        auto partKeys = trigrams(part);
+        keys.insert(keys.end(), partKeys.begin(), partKeys.end());
+    }
+
+    std::vector<std::vector<uint32_t>> lists;
+    std::vector<bool> unsorted;
+    uint32_t slotCount = 0;
+    {
+        std::shared_lock lock(_mutex);
+        slotCount = static_cast<uint32_t>(_present.size());
+        lists.reserve(keys.size());
+        for (auto key : keys)
+        {
+            auto it = _postings.find(key);
+            if(it == _postings.end())
+                return result;
+            lists.push_back(it->second);
+            unsorted.push_back(_unsorted.count(key) != 0);
+        }
+    }
+
+    //postings changed after prepare() are sorted on the copies
+    for (size_t i = 0; i < lists.size(); ++i)
+    {
+        if(!unsorted[i])
+            continue;
+        std::sort(lists[i].begin(), lists[i].end());
+        lists[i].erase(std::unique(lists[i].begin(), lists[i].end()), lists[i].end());
+    }
+
+    std::vector<uint32_t> candidates;
+    if(lists.empty())
+    {
+        //literals are too short for trigrams, every name has to be checked
+        for (uint32_t slot = 0; slot < slotCount; ++slot)
+            candidates.push_back(slot);
+    }
+    else
+    {
+        std::sort(lists.begin(), lists.end(), [](const auto &lhs, const auto &rhs){ return lhs.size() < rhs.size(); });
+        candidates = std::move(lists.front());
+        std::vector<uint32_t> intersection;
+        for (auto it = lists.begin() + 1; it != lists.end() && !candidates.empty(); ++it)
+        {
+            intersection.clear();
+            std::set_intersection(candidates.begin(), candidates.end(), it->begin(), it->end(), std::back_inserter(intersection));
+            candidates.swap(intersection);
+        }
+    }
+
+    QRegularExpression re(QRegularExpression::wildcardToRegularExpression(wildcard, QRegularExpression::UnanchoredWildcardConversion),
+                          cs == Qt::CaseInsensitive ? QRegularExpression::CaseInsensitiveOption : QRegularExpression::NoPatternOption);
+    //names are copied a chunk at a time, the copies share their data with the index
+    std::vector<std::pair<uint32_t, QString>> names;
+    for (size_t first = 0; first < candidates.size(); first += CANCEL_CHECK)
+    {
+        if(cancelled && cancelled())
+            return {};
+        auto last = std::min(candidates.size(), first + CANCEL_CHECK);
+
+        names.clear();
+        {
+            std::shared_lock lock(_mutex);
+            for (auto i = first; i < last; ++i)
+            {
+                auto slot = candidates[i];
+                if(slot < _present.size() && _present[slot])
+                    names.emplace_back(slot, _names[slot]);
+            }
+        }
+        for (const auto &[slot, name] : names)
+        {
+            if(re.match(name).hasMatch())
+                result.push_back(slot);
+        }
+    }
+    return result;
+}
+
+std::vector<NameIndex::Trigram> NameIndex::trigrams(const QString &text)
+{
+    std::vector<Trigram> result;
+    if(text.size() < 3)
+        return result;
+
+    //lower case keys serve case sensitive and insensitive queries alike
+    auto lower = text.toLower();
+    result.reserve(lower.size() - 2);
+    for (qsizetype i = 0; i + 2 < lower.size(); ++i)
+    {
+        result.push_back(static_cast<Trigram>(lower[i].unicode()) << 32 |
+                         static_cast<Trigram>(lower[i + 1].unicode()) << 16 |
+                         static_cast<Trigram>(lower[i + 2].unicode()));
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+std::vector<QString> NameIndex::literals(const QString &wildcard)
+{
+    std::vector<QString> result;
+    QString current;
+    bool inClass = false;
+    for (auto c : wildcard)
+    {
+        if(inClass)
+        {
+            inClass = c != ']';
+            continue;
+        }
+        if(c == '*' || c == '?' || c == '[')
+        {
+            inClass = c == '[';
+            if(!current.isEmpty())
+                result.push_back(current);
+            current.clear();
+            continue;
+        }
+        current.append(c);
+    }
+    if(!current.isEmpty())
+        result.push_back(current);
+    return result;
+}
+
+void NameIndex::insert(uint32_t slot, const QString &name)
+{
+    for (auto key : trigrams(name))
+    {
+        auto &posting = _postings[key];
+        if(!posting.empty() && posting.back() == slot)
+            continue;
+        if(!posting.empty() && posting.back() > slot)
+            _unsorted.insert(key);
+        posting.push_back(slot);
+        ++_entries;
+    }
+}
+
+void NameIndex::compact()
+{
+    _postings.clear();
+    _unsorted.clear();
+    _entries = 0;
+    _stale = 0;
+    for (uint32_t slot = 0; slot < _names.size(); ++slot)
+    {
+        if(_present[slot])
+            insert(slot, _names[slot]);
+    }
+}
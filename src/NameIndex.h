@@ -0,0 +1,51 @@
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include "ObjectRegistry.h"
+#include <QString>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <shared_mutex>
+
+//Trigram index over object names, addressed by registry slots.
+//Wildcard queries intersect the postings of trigrams from the literal parts of the pattern
+//and check the remaining candidates against the full pattern.
+//Queries may run on worker threads while the GUI thread keeps the index up to date.
+class NameIndex : public vsg::Inherit<vsg::Object, NameIndex>
+{
+public:
+    void build(const ObjectRegistry &registry);
+
+    void set(uint32_t slot, const QString &name);
+    void remove(uint32_t slot);
+
+    //sorts postings changed since the last query, so that queries do not have to
+    void prepare();
+
+    //sorted slots of the objects whose names match, with the same semantics as QSortFilterProxyModel::setFilterWildcard
+    std::vector<uint32_t> match(const QString &wildcard, Qt::CaseSensitivity cs, const std::function<bool()> &cancelled = {}) const;
+
+private:
+    using Trigram = uint64_t;
+
+    static std::vector<Trigram> trigrams(const QString &text);
+    static std::vector<QString> literals(const QString &wildcard);
+
+    void insert(uint32_t slot, const QString &name);
+    void compact();
+
+    std::vector<QString> _names;
+    std::vector<bool> _present;
+
+    //postings keep stale slots after renames and removals until compaction, candidates are verified anyway
+    std::unordered_map<Trigram, std::vector<uint32_t>> _postings;
+    std::unordered_set<Trigram> _unsorted;
+
+    mutable std::shared_mutex _mutex;
+
+    size_t _entries = 0;
+    size_t _stale = 0;
+};
+
+#endif // NAMEINDEX_H
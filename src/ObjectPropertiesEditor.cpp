@@ -5,9 +5,12 @@
 #include "sceneobjectvisitor.h"
 #include "tools.h"
 #include <QSignalBlocker>
+#include <QTimer>
+#include <algorithm>
 
 ObjectPropertiesEditor::ObjectPropertiesEditor(DatabaseManager *database, QWidget *parent) : Tool(database, parent)
     , _ellipsoidModel(database->route->atmosphere->ellipsoidModel)
+    , _geo(*_ellipsoidModel)
     , ui(new Ui::ObjectPropertiesEditor)
 {
     ui->setupUi(this);
@@ -16,7 +19,15 @@ ObjectPropertiesEditor::ObjectPropertiesEditor(DatabaseManager *database, QWidge
 
     //ui->stationBox->setModel(new StationsModel(_database->topology));
 
-    connect(stack, &QUndoStack::indexChanged, this, &ObjectPropertiesEditor::updateData);
+    //only steps that touch the selection refresh the fields, removed objects leave it
+    connect(_database->tilesModel, &SceneModel::changed, this, [this](const ChangeSet &changes)
+    {
+        if(_selection.empty() || !changes.affects(_selection.ids()))
+            return;
+        if(!changes.removed.empty())
+            highlight(_selection.subtract(changes.removed));
+        updateData();
+    });
 
     connect(ui->ecefXspin, &QDoubleSpinBox::valueChanged, this, &ObjectPropertiesEditor::updatePositionECEF);
     connect(ui->ecefYspin, &QDoubleSpinBox::valueChanged, this, &ObjectPropertiesEditor::updatePositionECEF);
@@ -30,6 +41,20 @@ ObjectPropertiesEditor::ObjectPropertiesEditor(DatabaseManager *database, QWidge
     connect(ui->rotYspin, &QDoubleSpinBox::valueChanged, this, &ObjectPropertiesEditor::updateRotation);
     connect(ui->rotZspin, &QDoubleSpinBox::valueChanged, this, &ObjectPropertiesEditor::updateRotation);
 
+    //spin box edits are applied at most once per frame, a gesture lasts until the user pauses or leaves the field
+    _frameTimer = new QTimer(this);
+    _frameTimer->setSingleShot(true);
+    _frameTimer->setInterval(FRAME_INTERVAL);
+    connect(_frameTimer, &QTimer::timeout, this, &ObjectPropertiesEditor::applyPending);
+
+    _gestureTimer = new QTimer(this);
+    _gestureTimer->setSingleShot(true);
+    _gestureTimer->setInterval(GESTURE_PAUSE);
+    connect(_gestureTimer, &QTimer::timeout, this, &ObjectPropertiesEditor::endGesture);
+
+    for (auto spin : {ui->ecefXspin, ui->ecefYspin, ui->ecefZspin, ui->latSpin, ui->lonSpin, ui->altSpin, ui->rotXspin, ui->rotYspin, ui->rotZspin})
+        connect(spin, &QDoubleSpinBox::editingFinished, this, &ObjectPropertiesEditor::endGesture);
+
     connect(ui->llaCombo, &QComboBox::currentIndexChanged, this, [this](int index)
     {
         auto step = 0.0001 * std::pow(100, index);
@@ -62,7 +87,7 @@ ObjectPropertiesEditor::ObjectPropertiesEditor(DatabaseManager *database, QWidge
 
     connect(ui->nameEdit, &QLineEdit::textEdited, this, [stack, this](const QString &text)
     {
-        stack->push(new RenameObject(*_selectedObjects.begin(), text));
+        stack->push(new RenameObject(_database->tilesModel, frontObject(), text));
     });
 
     connect(ui->stationBox, &QComboBox::currentIndexChanged, this, [this](int idx)
@@ -91,38 +116,24 @@ ObjectPropertiesEditor::~ObjectPropertiesEditor()
 
 void ObjectPropertiesEditor::applyTransform(const vsg::dvec3 &delta)
 {
-    if(_selectedObjects.size() > 1)
-        _database->undoStack->push(new MoveObjects(_selectedObjects, delta));
+    //goes through the model even for one object, so that the move is published
+    auto command = new MoveObjects(_database->tilesModel, _database->registry, selectedIds(), delta);
+    if(command->changed())
+        _database->undoStack->push(command);
     else
-    {
-        auto object = static_cast<route::MVCObject*>(_selectedObjects.begin()->internalPointer());
-        auto pos = object->getPosition() + delta;
-        _database->undoStack->push(new MoveObject(object, pos));
-    }
+        delete command;
 }
 
 void ObjectPropertiesEditor::selectIndex(const QItemSelection &selected, const QItemSelection &deselected)
 {
-    for (const auto &index : deselected.indexes())
-    {
-        if(auto it = _selectedObjects.find(index); it != _selectedObjects.end())
-        {
-            auto object = static_cast<route::MVCObject*>(index.internalPointer());
-            object->setSelection(false);
-            _selectedObjects.erase(it);
-        }
-    }
-
-    for (const auto &index : selected.indexes())
-    {
-        if(_selectedObjects.find(index) != _selectedObjects.end())
-            continue;
-        auto object = static_cast<route::MVCObject*>(index.internalPointer());
-
-        object->setSelection(true);
-        _selectedObjects.insert(index);
-        emit objectClicked(index);
-    }
+    endGesture();
+    //the view already shows this selection, so it is not notified back
+    auto delta = _selection.subtract(selectionIds(deselected));
+    auto added = _selection.add(selectionIds(selected));
+    delta.selected = std::move(added.selected);
+    if(delta.empty())
+        return;
+    highlight(delta);
     updateData();
 }
 
@@ -135,40 +146,94 @@ void ObjectPropertiesEditor::selectObject(route::SceneObject *object)
 
 void ObjectPropertiesEditor::updatePositionECEF(double)
 {
-    auto object = static_cast<route::MVCObject*>(_selectedObjects.begin()->internalPointer());
-    auto x = ui->ecefXspin->value();
-    auto y = ui->ecefYspin->value();
-    auto z = ui->ecefZspin->value();
+    schedule(PositionECEF);
+}
 
-    vsg::dvec3 pos{x,y,z};
+void ObjectPropertiesEditor::updatePositionLLA(double)
+{
+    schedule(PositionLLA);
+}
 
-    if(_selectedObjects.size() > 1)
+void ObjectPropertiesEditor::schedule(Edit edit)
+{
+    _pending |= edit;
+    if(_gesture == 0)
+        _gesture = ++_gestures;
+    _gestureTimer->start();
+    if(!_frameTimer->isActive())
+        _frameTimer->start();
+}
+
+void ObjectPropertiesEditor::endGesture()
+{
+    if(_frameTimer->isActive())
     {
-        pos -= object->getPosition();
-        _database->undoStack->push(new MoveObjects(_selectedObjects, pos));
+        _frameTimer->stop();
+        applyPending();
     }
-    else
-        _database->undoStack->push(new MoveObject(object, pos));
+    _gesture = 0;
 }
 
-void ObjectPropertiesEditor::updatePositionLLA(double)
+void ObjectPropertiesEditor::applyPending()
 {
-    auto object = static_cast<route::MVCObject*>(_selectedObjects.begin()->internalPointer());
-    auto lat = ui->latSpin->value();
-    auto lon = ui->lonSpin->value();
-    auto alt = ui->altSpin->value();
-    auto ltw = object->getWorldTransform();
-    auto ecef = _ellipsoidModel->convertLatLongAltitudeToECEF({lat, lon, alt});
+    auto pending = _pending;
+    _pending = 0;
+    if(_selection.empty())
+        return;
+
+    auto object = frontObject();
+    auto ids = selectedIds();
+    auto push = [this](TransformObjects *command)
+    {
+        //e.g. a spin box edited back to the value it had
+        if(!command->changed())
+        {
+            delete command;
+            return;
+        }
+        command->setGesture(_gesture);
+        _database->undoStack->push(command);
+    };
 
-    if(_selectedObjects.size() > 1)
+    if(pending & PositionECEF)
     {
-        ecef -= vsg::dvec3{ltw(3,0), ltw(3,1), ltw(3,2)};
-        _database->undoStack->push(new MoveObjects(_selectedObjects, ecef));
+        vsg::dvec3 pos{ui->ecefXspin->value(), ui->ecefYspin->value(), ui->ecefZspin->value()};
+        push(new MoveObjects(_database->tilesModel, _database->registry, ids, pos - object->getPosition()));
     }
-    else
+    else if(pending & PositionLLA)
     {
-        auto pos = vsg::inverse(ltw) * ecef;
-        _database->undoStack->push(new MoveObject(object, pos));
+        //every object is shifted by the same latitude, longitude and altitude, so a layout follows the surface
+        GroupTransform group(*_database->registry, ids);
+        auto lla = selectionLatLongAltitude(group);
+        auto delta = vsg::dvec3{ui->latSpin->value(), ui->lonSpin->value(), ui->altSpin->value()} - lla.get(0);
+        for (size_t i = 0; i < lla.size(); ++i)
+            lla.set(i, lla.get(i) + delta);
+
+        CoordinateArrays ecef;
+        _geo.toECEF(lla, ecef);
+        std::vector<vsg::dvec3> positions(ecef.size());
+        for (size_t i = 0; i < positions.size(); ++i)
+            positions[i] = ecef.get(i);
+        group.toLocal(positions);
+        push(new PlaceObjects(_database->tilesModel, _database->registry, ids, positions));
+    }
+
+    if(pending & Rotation)
+    {
+        auto x = qDegreesToRadians(ui->rotXspin->value());
+        auto y = qDegreesToRadians(ui->rotYspin->value());
+        auto z = qDegreesToRadians(ui->rotZspin->value());
+        auto to = route::toQuaternion(x, y, z);
+        if(ids.size() > 1)
+        {
+            //the selection turns about its centroid, so that a layout keeps its shape,
+            //the bounds center would move with every step of a drag and the layout would drift
+            GroupTransform group(*_database->registry, ids);
+            auto delta = to * tools::inverse(object->getRotation());
+            push(new TransformGroup(_database->tilesModel, _database->registry, ids, group, group.rotation(group.centroid(), delta)));
+        }
+        else
+            push(new RotateObjects(_database->tilesModel, _database->registry, ids, to));
     }
 }
 /*
@@ -198,40 +263,129 @@ void ObjectPropertiesEditor::updateRotationZ(double val)
 */
 void ObjectPropertiesEditor::updateRotation(double)
 {
-    auto x = qDegreesToRadians(ui->rotXspin->value());
-    auto y = qDegreesToRadians(ui->rotYspin->value());
-    auto z = qDegreesToRadians(ui->rotZspin->value());
-    _database->undoStack->push(new RotateObjects(_selectedObjects, route::toQuaternion(x, y, z)));
+    schedule(Rotation);
 }
 
 void ObjectPropertiesEditor::toggle(route::SceneObject *object)
 {
-    auto index = _database->tilesModel->index(object);
-    if(auto selectedIt = _selectedObjects.find(index); selectedIt != _selectedObjects.end())
+    //an edit still waiting for the next frame belongs to the old selection
+    endGesture();
+    auto id = _database->registry->id(object);
+    auto index = _database->tilesModel->reveal(object);
+    if(_selection.contains(id))
     {
-        auto selected = static_cast<route::MVCObject*>(index.internalPointer());
-        selected->setSelection(false);
-
-        //_selectedObjects.erase(selectedIt);
-        emit deselectItem(*selectedIt);
+        highlight(_selection.subtract({id}));
+        emit deselectItem(index);
     }
     else
     {
-        object->setSelection(true);
-        _selectedObjects.insert(index);
+        highlight(_selection.add({id}));
         emit objectClicked(index);
     }
 }
 void ObjectPropertiesEditor::clear()
 {
-    for (auto &index : qAsConst(_selectedObjects)) {
-        auto object = static_cast<route::MVCObject*>(index.internalPointer());
-        object->setSelection(false);
-    }
-    _selectedObjects.clear();
+    endGesture();
+    highlight(_selection.clear());
     emit deselect();
 }
 
+CoordinateArrays ObjectPropertiesEditor::selectionLatLongAltitude(const GroupTransform &group) const
+{
+    const auto &world = group.worldPositions();
+    CoordinateArrays ecef;
+    ecef.resize(world.size());
+    for (size_t i = 0; i < world.size(); ++i)
+        ecef.set(i, world[i]);
+
+    CoordinateArrays lla;
+    _geo.toLatLongAltitude(ecef, lla);
+    return lla;
+}
+
+std::vector<ObjectRegistry::ID> ObjectPropertiesEditor::selectedIds() const
+{
+    //the first selected object leads relative moves and rotations, so it stays first
+    auto ids = _selection.ids();
+    if(auto front = std::find(ids.begin(), ids.end(), _selection.front()); front != ids.end())
+        std::iter_swap(ids.begin(), front);
+    return ids;
+}
+
+route::MVCObject *ObjectPropertiesEditor::frontObject() const
+{
+    return _database->registry->object(_selection.front());
+}
+
+void ObjectPropertiesEditor::highlight(const SelectionSet::Delta &delta)
+{
+    for (auto id : delta.deselected)
+        if(auto object = _database->registry->object(id); object)
+            object->setSelection(false);
+    for (auto id : delta.selected)
+        if(auto object = _database->registry->object(id); object)
+            object->setSelection(true);
+}
+
+std::vector<ObjectRegistry::ID> ObjectPropertiesEditor::selectionIds(const QItemSelection &selection) const
+{
+    //ranges instead of indexes(), which lists every column of every row
+    std::vector<ObjectRegistry::ID> ids;
+    for (const auto &range : selection)
+    {
+        for (int row = range.top(); row <= range.bottom(); ++row)
+        {
+            auto index = range.model()->index(row, 0, range.parent());
+            ids.push_back(_database->registry->id(static_cast<route::MVCObject*>(index.internalPointer())));
+        }
+    }
+    return ids;
+}
+
+QItemSelection ObjectPropertiesEditor::itemSelection(const std::vector<ObjectRegistry::ID> &ids) const
+{
+    //rows of the selected objects are fetched first, one insertion per parent
+    std::vector<const route::MVCObject*> nodes;
+    nodes.reserve(ids.size());
+    for (auto id : ids)
+        if(auto node = _database->registry->object(id))
+            nodes.push_back(node);
+    _database->tilesModel->reveal(nodes);
+
+    QItemSelection selection;
+    for (auto id : ids)
+    {
+        auto index = _database->tilesModel->index(id);
+        if(index.isValid())
+            selection.select(index, index);
+    }
+    return selection;
+}
+
+void ObjectPropertiesEditor::invertSelection()
+{
+    if(_selection.empty())
+        return;
+    endGesture();
+
+    std::unordered_set<route::MVCObject*> groups;
+    for (auto id : _selection.ids())
+        if(auto object = _database->registry->object(id); object && object->parent())
+            groups.insert(object->parent());
+
+    std::vector<ObjectRegistry::ID> universe;
+    for (auto group : groups)
+        for (int i = 0; i < group->childrenCount(); ++i)
+            if(auto object = group->at(i)->cast<route::SceneObject>(); object)
+                universe.push_back(_database->registry->id(object));
+
+    auto delta = _selection.invert(std::move(universe));
+    highlight(delta);
+    emit objectsDeselected(itemSelection(delta.deselected));
+    emit objectsSelected(itemSelection(delta.selected));
+    updateData();
+}
+
 void ObjectPropertiesEditor::setSpinEanbled(bool enabled)
 {
     ui->nameEdit->setEnabled(enabled);
@@ -249,6 +403,7 @@ void ObjectPropertiesEditor::setSpinEanbled(bool enabled)
 
 void ObjectPropertiesEditor::updateData()
 {
+    UndoProfiler::Scope scope("ObjectPropertiesEditor::updateData", UndoProfiler::Handler);
     QSignalBlocker l1(ui->ecefXspin);
     QSignalBlocker l2(ui->ecefYspin);
     QSignalBlocker l3(ui->ecefZspin);
@@ -260,7 +415,7 @@ void ObjectPropertiesEditor::updateData()
     QSignalBlocker l9(ui->rotZspin);
     QSignalBlocker l10(ui->trjCoordspin);
 
-    if(_selectedObjects.empty())
+    if(_selection.empty())
     {
         setEnabled(false);
         return;
@@ -269,7 +424,7 @@ void ObjectPropertiesEditor::updateData()
         setEnabled(true);
     setSpinEanbled(true);
 
-    auto object = static_cast<route::MVCObject*>(_selectedObjects.begin()->internalPointer());
+    auto object = frontObject();
 /*
     if(_firstObject->is_compatible(typeid (route::RailPoint)))
     {
@@ -325,11 +480,26 @@ void ObjectPropertiesEditor::updateData()
     ui->ecefYspin->setValue(position.y);
     ui->ecefZspin->setValue(position.z);
 
-    auto lla = _ellipsoidModel->convertECEFToLatLongAltitude(object->getPosition());
+    //the fields show the first object, their tooltips the extent of the whole selection
+    auto lla = selectionLatLongAltitude(GroupTransform(*_database->registry, selectedIds()));
 
-    ui->latSpin->setValue(lla.x);
-    ui->lonSpin->setValue(lla.y);
-    ui->altSpin->setValue(lla.z);
+    ui->latSpin->setValue(lla.x.front());
+    ui->lonSpin->setValue(lla.y.front());
+    ui->altSpin->setValue(lla.z.front());
+
+    auto extent = [&lla](QDoubleSpinBox *spin, const std::vector<double> &values)
+    {
+        if(lla.size() < 2)
+        {
+            spin->setToolTip(QString());
+            return;
+        }
+        auto [min, max] = std::minmax_element(values.begin(), values.end());
+        spin->setToolTip(tr("%1 … %2").arg(*min, 0, 'f', spin->decimals()).arg(*max, 0, 'f', spin->decimals()));
+    };
+    extent(ui->latSpin, lla.x);
+    extent(ui->lonSpin, lla.y);
+    extent(ui->altSpin, lla.z);
 
     auto quat = object->getRotation();
 
@@ -366,12 +536,21 @@ void ObjectPropertiesEditor::apply(vsg::KeyPressEvent &press)
         _single = true;
     if(press.keyModifier & vsg::MODKEY_Shift)
         _shift = true;
+    if(press.keyModifier & vsg::MODKEY_Alt)
+        _alt = true;
 
     switch (press.keyBase) {
     case vsg::KEY_M:
     {
         break;
     }
+    case vsg::KEY_i:
+    case vsg::KEY_I:
+    {
+        if(press.keyModifier & vsg::MODKEY_Control)
+            invertSelection();
+        break;
+    }
     default:
         break;
 
@@ -384,11 +563,22 @@ void ObjectPropertiesEditor::apply(vsg::KeyReleaseEvent &release)
         _single = false;
     if(release.keyModifier & vsg::MODKEY_Shift)
         _shift = false;
+    if(release.keyModifier & vsg::MODKEY_Alt)
+        _alt = false;
 }
 
 void ObjectPropertiesEditor::apply(vsg::ButtonPressEvent &press)
 {
-    auto isection = route::testIntersections(press, _database->root, _camera);
+    if(_alt && press.button == 1)
+    {
+        _region = _shift ? Lasso : Rectangle;
+        _regionPoints = {vsg::dvec2(press.x, press.y)};
+        return;
+    }
+
+    //terrain is picked too, so that it hides the objects behind it,
+    //only the first hit is used and a terrain hit has no object on its path, so it selects nothing
+    auto isection = intersect(press, Picker::Terrain | Picker::Objects | Picker::Connectors);
 
      if(_single)
          clear();
@@ -412,10 +602,80 @@ void ObjectPropertiesEditor::apply(vsg::ButtonPressEvent &press)
      updateData();
 }
 
-void ObjectPropertiesEditor::apply(vsg::ButtonReleaseEvent &)
+void ObjectPropertiesEditor::apply(vsg::ButtonReleaseEvent &release)
+{
+    if(_region == NoRegion || release.button != 1)
+        return;
+
+    _regionPoints.emplace_back(release.x, release.y);
+    selectRegion();
+
+    _region = NoRegion;
+    _regionPoints.clear();
+}
+
+void ObjectPropertiesEditor::apply(vsg::MoveEvent &move)
 {
+    if(_region == NoRegion)
+        return;
+
+    vsg::dvec2 point(move.x, move.y);
+    if(_region == Rectangle && _regionPoints.size() > 1)
+        _regionPoints.back() = point;
+    else
+        _regionPoints.push_back(point);
 }
 
-void ObjectPropertiesEditor::apply(vsg::MoveEvent &)
+void ObjectPropertiesEditor::selectRegion()
 {
+    auto min = _regionPoints.front();
+    auto max = min;
+    for (const auto &point : _regionPoints)
+    {
+        min.x = std::min(min.x, point.x);
+        min.y = std::min(min.y, point.y);
+        max.x = std::max(max.x, point.x);
+        max.y = std::max(max.y, point.y);
+    }
+    if(max.x - min.x < 2.0 || max.y - min.y < 2.0)
+        return;
+
+    auto polytope = SpatialIndex::screenPolytope(*_camera, min, max);
+    auto found = _database->spatialIndex->intersect(polytope);
+
+    if(_region == Lasso)
+    {
+        auto outside = [this](const SpatialIndex::Entry &entry)
+        {
+            auto point = SpatialIndex::project(*_camera, (entry.bounds.min + entry.bounds.max) * 0.5);
+            bool inside = false;
+            for (size_t i = 0, j = _regionPoints.size() - 1; i < _regionPoints.size(); j = i++)
+            {
+                const auto &a = _regionPoints[i];
+                const auto &b = _regionPoints[j];
+                if((a.y > point.y) != (b.y > point.y) && point.x < (b.x - a.x) * (point.y - a.y) / (b.y - a.y) + a.x)
+                    inside = !inside;
+            }
+            return !inside;
+        };
+        found.erase(std::remove_if(found.begin(), found.end(), outside), found.end());
+    }
+
+    if(_single)
+        clear();
+    else
+        endGesture();
+
+    std::vector<ObjectRegistry::ID> ids;
+    ids.reserve(found.size());
+    for (const auto &entry : found)
+        ids.push_back(_database->registry->id(entry.object));
+
+    //highlights first, the view then gets only the objects that were not selected yet, in one batch
+    auto delta = _selection.add(std::move(ids));
+    highlight(delta);
+
+    emit sendStatusText(tr("Выделено объектов: %1").arg(found.size()), 2000);
+    emit objectsSelected(itemSelection(delta.selected));
+    updateData();
 }
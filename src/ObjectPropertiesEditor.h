@@ -2,8 +2,12 @@
 #define OBJECTPROPERTIESEDITOR_H
 
 #include "tool.h"
+#include "GeoBatch.h"
+#include "GroupTransform.h"
+#include "SelectionSet.h"
 #include <unordered_set>
 #include <QItemSelectionModel>
+#include <QTimer>
 #include <vsg/app/EllipsoidModel.h>
 
 namespace Ui {
@@ -25,31 +29,79 @@ public slots:
     void selectIndex(const QItemSelection &selected, const QItemSelection &deselected);
     void applyTransform(const vsg::dvec3 &delta);
     void selectObject(route::SceneObject *object);
+    //selects the unselected objects of the groups the selection is in and deselects the selected ones
+    void invertSelection();
 
     void updatePositionECEF(double);
     void updatePositionLLA(double);
 
     void updateRotation(double);
 
+private slots:
+    void applyPending();
+    void endGesture();
+
 signals:
     void objectClicked(const QModelIndex &index);
     void deselect();
     void deselectItem(const QModelIndex &index);
+    void objectsSelected(const QItemSelection &selection);
+    void objectsDeselected(const QItemSelection &selection);
     //void sendFirst(vsg::ref_ptr<route::SceneObject> firstObject);
 
 private:
     void clear();
     void toggle(route::SceneObject* object);
     void setSpinEanbled(bool enabled);
+    std::vector<ObjectRegistry::ID> selectedIds() const;
+    route::MVCObject *frontObject() const;
+
+    //one pass over the objects whose state changed
+    void highlight(const SelectionSet::Delta &delta);
+    std::vector<ObjectRegistry::ID> selectionIds(const QItemSelection &selection) const;
+    QItemSelection itemSelection(const std::vector<ObjectRegistry::ID> &ids) const;
+    void selectRegion();
+    //geographic coordinates of the selected objects' origins
+    CoordinateArrays selectionLatLongAltitude(const GroupTransform &group) const;
+
+    enum Edit
+    {
+        PositionECEF = 1,
+        PositionLLA = 2,
+        Rotation = 4
+    };
+
+    void schedule(Edit edit);
+
+    static constexpr int FRAME_INTERVAL = 16;
+    static constexpr int GESTURE_PAUSE = 500;
+
+    enum Region
+    {
+        NoRegion,
+        Rectangle,
+        Lasso
+    };
 
     Ui::ObjectPropertiesEditor *ui;
 
     vsg::ref_ptr<vsg::EllipsoidModel> _ellipsoidModel;
+    GeoBatch _geo;
 
-    QSet<QModelIndex> _selectedObjects;
+    SelectionSet _selection;
 
     bool _single = true;
     bool _shift = false;
+    bool _alt = false;
+
+    Region _region = NoRegion;
+    std::vector<vsg::dvec2> _regionPoints;
+
+    QTimer *_frameTimer;
+    QTimer *_gestureTimer;
+    int _pending = 0;
+    quint32 _gesture = 0;
+    quint32 _gestures = 0;
 
     // Visitor interface
 public:
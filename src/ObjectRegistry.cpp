@@ -0,0 +1,128 @@
+#include "ObjectRegistry.h"
+
+void ObjectRegistry::addTree(route::MVCObject *root)
+{
+    //new IDs start above every stored one, so that an object without an ID can not take the ID of a later one
+    reserveStored(root);
+    addChildren(root);
+}
+
+void ObjectRegistry::reserveStored(route::MVCObject *root)
+{
+    if(auto id = storedId(root); id != NULL_ID)
+        _next = std::max(_next, id + 1);
+    for (int i = 0; i < root->childrenCount(); ++i)
+        reserveStored(root->at(i));
+}
+
+void ObjectRegistry::addChildren(route::MVCObject *root)
+{
+    add(root);
+    for (int i = 0; i < root->childrenCount(); ++i)
+        addChildren(root->at(i));
+}
+
+ObjectRegistry::ID ObjectRegistry::add(route::MVCObject *object)
+{
+    if(auto it = _byObject.find(object); it != _byObject.end())
+    {
+        if(alive(it->second) == object)
+            return _slots[it->second].id;
+        //the address belonged to an object that has been destroyed
+        release(it->second);
+    }
+
+    auto id = storedId(object);
+    if(id != NULL_ID)
+    {
+        if(auto it = _byId.find(id); it != _byId.end())
+        {
+            //copies carry the ID of their original
+            if(alive(it->second))
+                id = NULL_ID;
+            else
+                release(it->second);
+        }
+    }
+
+    if(id == NULL_ID)
+    {
+        id = _next;
+        object->setValue(ID_KEY, vsg::uivec2(static_cast<uint32_t>(id), static_cast<uint32_t>(id >> 32)));
+    }
+    _next = std::max(_next, id + 1);
+
+    insert(object, id);
+    return id;
+}
+
+ObjectRegistry::ID ObjectRegistry::id(const route::MVCObject *object) const
+{
+    auto slot = this->slot(object);
+    return slot == NULL_SLOT ? NULL_ID : _slots[slot].id;
+}
+
+route::MVCObject *ObjectRegistry::object(ID id) const
+{
+    auto slot = this->slot(id);
+    return slot == NULL_SLOT ? nullptr : alive(slot);
+}
+
+uint32_t ObjectRegistry::slot(ID id) const
+{
+    auto it = _byId.find(id);
+    if(it == _byId.end() || !alive(it->second))
+        return NULL_SLOT;
+    return it->second;
+}
+
+uint32_t ObjectRegistry::slot(const route::MVCObject *object) const
+{
+    auto it = _byObject.find(object);
+    if(it == _byObject.end() || alive(it->second) != object)
+        return NULL_SLOT;
+    return it->second;
+}
+
+ObjectRegistry::ID ObjectRegistry::storedId(const route::MVCObject *object)
+{
+    vsg::uivec2 stored;
+    if(!object->getValue(ID_KEY, stored))
+        return NULL_ID;
+    return (static_cast<ID>(stored.y) << 32) | stored.x;
+}
+
+uint32_t ObjectRegistry::insert(route::MVCObject *object, ID id)
+{
+    uint32_t slot;
+    if(_free.empty())
+    {
+        slot = static_cast<uint32_t>(_slots.size());
+        _slots.push_back({id, object, vsg::observer_ptr<route::MVCObject>(object)});
+    }
+    else
+    {
+        slot = _free.back();
+        _free.pop_back();
+        _slots[slot] = {id, object, vsg::observer_ptr<route::MVCObject>(object)};
+    }
+    _byId[id] = slot;
+    _byObject[object] = slot;
+    return slot;
+}
+
+void ObjectRegistry::release(uint32_t slot)
+{
+    auto &entry = _slots[slot];
+    if(auto it = _byId.find(entry.id); it != _byId.end() && it->second == slot)
+        _byId.erase(it);
+    if(auto it = _byObject.find(entry.pointer); it != _byObject.end() && it->second == slot)
+        _byObject.erase(it);
+    entry = {NULL_ID, nullptr, {}};
+    _free.push_back(slot);
+}
+
+route::MVCObject *ObjectRegistry::alive(uint32_t slot) const
+{
+    return _slots[slot].object.ref_ptr().get();
+}
@@ -0,0 +1,56 @@
+#ifndef OBJECTREGISTRY_H
+#define OBJECTREGISTRY_H
+
+#include "sceneobjects.h"
+#include <vsg/core/observer_ptr.h>
+#include <unordered_map>
+
+//Route-wide persistent object IDs.
+//IDs are kept in the objects' user values, so they are written with the tiles and survive reloading.
+//Registered objects also get a dense slot, usable as an index into per-object arrays.
+class ObjectRegistry : public vsg::Inherit<vsg::Object, ObjectRegistry>
+{
+public:
+    using ID = uint64_t;
+    static constexpr ID NULL_ID = 0;
+    static constexpr uint32_t NULL_SLOT = 0xffffffff;
+
+    static constexpr const char *ID_KEY = "ID";
+
+    //registers the object and all of its children, objects carrying an ID that is taken by another one get a new ID
+    void addTree(route::MVCObject *root);
+    ID add(route::MVCObject *object);
+
+    ID id(const route::MVCObject *object) const;
+    route::MVCObject *object(ID id) const;
+
+    uint32_t slot(ID id) const;
+    uint32_t slot(const route::MVCObject *object) const;
+    ID slotId(uint32_t slot) const { return slot < _slots.size() ? _slots[slot].id : NULL_ID; }
+    size_t slotCount() const { return _slots.size(); }
+
+private:
+    static ID storedId(const route::MVCObject *object);
+    void reserveStored(route::MVCObject *root);
+    void addChildren(route::MVCObject *root);
+    uint32_t insert(route::MVCObject *object, ID id);
+    void release(uint32_t slot);
+    route::MVCObject *alive(uint32_t slot) const;
+
+    struct Slot
+    {
+        ID id;
+        const route::MVCObject *pointer; //key in _byObject, kept after the object is gone
+        vsg::observer_ptr<route::MVCObject> object;
+    };
+
+    std::vector<Slot> _slots;
+    std::vector<uint32_t> _free;
+
+    std::unordered_map<ID, uint32_t> _byId;
+    std::unordered_map<const route::MVCObject*, uint32_t> _byObject;
+
+    ID _next = 1;
+};
+
+#endif // OBJECTREGISTRY_H
@@ -0,0 +1,256 @@
+#include "Picker.h"
+#include "sceneobjects.h"
+#include "trajectory.h"
+#include <vsg/nodes/CullNode.h>
+#include <vsg/nodes/Geometry.h>
+#include <vsg/nodes/LOD.h>
+#include <vsg/nodes/PagedLOD.h>
+#include <vsg/nodes/StateGroup.h>
+#include <vsg/nodes/VertexDraw.h>
+#include <vsg/nodes/VertexIndexDraw.h>
+#include <vsg/commands/Draw.h>
+#include <vsg/commands/DrawIndexed.h>
+#include <vsg/utils/ComputeBounds.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+
+namespace
+{
+    class TaskCollector : public vsg::ConstVisitor
+    {
+    public:
+        explicit TaskCollector(const std::vector<const vsg::Node*> &in_spine) : spine(in_spine) {}
+
+        void apply(const vsg::Node &node) override
+        {
+            if(std::find(spine.begin(), spine.end(), &node) == spine.end())
+            {
+                bool cull = !path.empty() && path.back() == spine.back();
+                tasks.push_back({&node, path, transforms, {}, cull});
+                return;
+            }
+
+            auto transform = node.cast<vsg::Transform>();
+            if(transform)
+                transforms.push_back(transform);
+            path.push_back(&node);
+
+            node.traverse(*this);
+
+            path.pop_back();
+            if(transform)
+                transforms.pop_back();
+        }
+
+        const std::vector<const vsg::Node*> &spine;
+
+        vsg::NodePath path;
+        std::vector<const vsg::Transform*> transforms;
+        std::vector<Picker::Task> tasks;
+    };
+
+    //skips geometry of the layers that are not requested and whole subtrees when nothing below can match
+    class LayerIntersector : public vsg::Inherit<vsg::LineSegmentIntersector, LayerIntersector>
+    {
+    public:
+        LayerIntersector(const vsg::Camera &camera, int32_t x, int32_t y, uint32_t in_layers, const std::vector<const vsg::Node*> &in_gizmos)
+            : Inherit(camera, x, y)
+            , layers(in_layers)
+            , gizmos(in_gizmos)
+        {
+        }
+
+        void apply(const vsg::Node &node) override { enter(node); }
+        void apply(const vsg::StateGroup &stategroup) override { enter(stategroup); }
+        void apply(const vsg::Transform &transform) override { enter(transform); }
+        void apply(const vsg::LOD &lod) override { enter(lod); }
+        void apply(const vsg::PagedLOD &plod) override { enter(plod); }
+        void apply(const vsg::CullNode &cn) override { enter(cn); }
+
+        void apply(const vsg::VertexDraw &vd) override { draw(vd); }
+        void apply(const vsg::VertexIndexDraw &vid) override { draw(vid); }
+        void apply(const vsg::Geometry &geometry) override { draw(geometry); }
+        void apply(const vsg::Draw &draw) override { this->draw(draw); }
+        void apply(const vsg::DrawIndexed &drawIndexed) override { draw(drawIndexed); }
+
+        const uint32_t layers;
+        const std::vector<const vsg::Node*> &gizmos;
+
+    private:
+        uint32_t classify(const vsg::Node &node) const
+        {
+            if(std::find(gizmos.begin(), gizmos.end(), &node) != gizmos.end())
+                return Picker::Gizmos;
+            if(node.is_compatible(typeid(route::Connector)))
+                return Picker::Connectors;
+            if(node.is_compatible(typeid(route::SceneObject)))
+                return Picker::Objects;
+            if(node.is_compatible(typeid(route::Trajectory)))
+                return Picker::Tracks;
+            return 0;
+        }
+
+        //layers that may be found below a node of the given layer
+        static uint32_t reach(uint32_t layer)
+        {
+            switch (layer) {
+            case Picker::Objects:
+                return Picker::Objects | Picker::Connectors;
+            case Picker::Tracks:
+                return Picker::Tracks | Picker::Objects | Picker::Connectors;
+            default:
+                return layer;
+            }
+        }
+
+        template<class T>
+        void enter(const T &node)
+        {
+            auto layer = classify(node);
+            if(layer == 0)
+            {
+                vsg::LineSegmentIntersector::apply(node);
+                return;
+            }
+            if((layers & reach(layer)) == 0)
+                return;
+
+            auto parent = _layer;
+            _layer = layer;
+            vsg::LineSegmentIntersector::apply(node);
+            _layer = parent;
+        }
+
+        template<class T>
+        void draw(const T &geometry)
+        {
+            if(layers & _layer)
+                vsg::LineSegmentIntersector::apply(geometry);
+        }
+
+        uint32_t _layer = Picker::Terrain;
+    };
+
+    //same unprojection as LineSegmentIntersector(camera, x, y), the depth direction does not matter here
+    std::pair<vsg::dvec3, vsg::dvec3> segment(const vsg::Camera &camera, int32_t x, int32_t y)
+    {
+        auto viewport = camera.getViewport();
+        auto inverse = vsg::inverse(camera.projectionMatrix->transform() * camera.viewMatrix->transform());
+        vsg::dvec2 ndc((static_cast<double>(x) - viewport.x) / viewport.width * 2.0 - 1.0,
+                       (static_cast<double>(y) - viewport.y) / viewport.height * 2.0 - 1.0);
+
+        auto unproject = [&](double z)
+        {
+            auto world = inverse * vsg::dvec4(ndc.x, ndc.y, z, 1.0);
+            return vsg::dvec3(world.x, world.y, world.z) / world.w;
+        };
+        return {unproject(1.0), unproject(0.0)};
+    }
+
+    bool crosses(const vsg::dbox &box, const vsg::dvec3 &start, const vsg::dvec3 &end)
+    {
+        auto direction = end - start;
+        double tmin = 0.0;
+        double tmax = 1.0;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            auto padding = (box.max[axis] - box.min[axis]) * 1e-6 + 1e-3;
+            auto min = box.min[axis] - padding;
+            auto max = box.max[axis] + padding;
+            if(std::abs(direction[axis]) < 1e-12)
+            {
+                if(start[axis] < min || start[axis] > max)
+                    return false;
+                continue;
+            }
+            auto t1 = (min - start[axis]) / direction[axis];
+            auto t2 = (max - start[axis]) / direction[axis];
+            if(t1 > t2)
+                std::swap(t1, t2);
+            tmin = std::max(tmin, t1);
+            tmax = std::min(tmax, t2);
+            if(tmin > tmax)
+                return false;
+        }
+        return true;
+    }
+}
+
+Picker::Picker(vsg::ref_ptr<vsg::Node> root, const std::vector<const vsg::Node*> &spine)
+    : _root(root)
+    , _spine(spine)
+{
+}
+
+void Picker::addGizmo(const vsg::Node *gizmo)
+{
+    _gizmos.push_back(gizmo);
+}
+
+void Picker::rebuild()
+{
+    TaskCollector collector(_spine);
+    _root->accept(collector);
+    _tasks = std::move(collector.tasks);
+
+    tbb::parallel_for(size_t(0), _tasks.size(), [this](size_t i)
+    {
+        auto &task = _tasks[i];
+        if(!task.cull)
+            return;
+
+        vsg::dmat4 matrix;
+        for (auto transform : task.transforms)
+            matrix = transform->transform(matrix);
+
+        vsg::ComputeBounds computeBounds;
+        computeBounds.matrixStack.push_back(matrix);
+        task.node->accept(computeBounds);
+
+        task.bounds = computeBounds.bounds;
+        task.cull = task.bounds.valid();
+    });
+
+    _dirty = false;
+}
+
+vsg::LineSegmentIntersector::Intersections Picker::intersect(const vsg::PointerEvent &event, const vsg::Camera &camera, uint32_t layers)
+{
+    if(_dirty)
+        rebuild();
+
+    auto [start, end] = segment(camera, event.x, event.y);
+
+    std::vector<const Task*> active;
+    for (const auto &task : _tasks)
+    {
+        if(!task.cull || crosses(task.bounds, start, end))
+            active.push_back(&task);
+    }
+
+    std::vector<vsg::LineSegmentIntersector::Intersections> results(active.size());
+
+    tbb::parallel_for(size_t(0), active.size(), [&](size_t i)
+    {
+        const auto &task = *active[i];
+
+        auto intersector = LayerIntersector::create(camera, event.x, event.y, layers, _gizmos);
+        for (auto transform : task.transforms)
+            intersector->pushTransform(*transform);
+
+        task.node->accept(*intersector);
+
+        for (auto &intersection : intersector->intersections)
+            intersection->nodePath.insert(intersection->nodePath.begin(), task.path.begin(), task.path.end());
+
+        results[i] = std::move(intersector->intersections);
+    });
+
+    vsg::LineSegmentIntersector::Intersections intersections;
+    for (auto &result : results)
+        intersections.insert(intersections.end(), result.begin(), result.end());
+
+    std::stable_sort(intersections.begin(), intersections.end(), [](auto& lhs, auto& rhs) { return lhs->ratio < rhs->ratio; });
+
+    return intersections;
+}
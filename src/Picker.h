@@ -0,0 +1,56 @@
+#ifndef PICKER_H
+#define PICKER_H
+
+#include <vsg/app/Camera.h>
+#include <vsg/maths/box.h>
+#include <vsg/nodes/Transform.h>
+#include <vsg/ui/PointerEvent.h>
+#include <vsg/utils/LineSegmentIntersector.h>
+
+//Splits the scene into subtrees hanging off the spine nodes and intersects them in parallel.
+//Children of the last spine node (tiles) are culled by their cached bounds first.
+//Results match a serial LineSegmentIntersector traversal from the root, sorted by ratio.
+class Picker : public vsg::Inherit<vsg::Object, Picker>
+{
+public:
+    enum Layer : uint32_t
+    {
+        Terrain = 1 << 0,    //geometry outside of any scene object or trajectory
+        Objects = 1 << 1,
+        Tracks = 1 << 2,
+        Connectors = 1 << 3,
+        Gizmos = 1 << 4,     //wire boxes, axes and the cursor
+        Scene = Terrain | Objects | Tracks | Connectors,
+        All = Scene | Gizmos
+    };
+
+    Picker(vsg::ref_ptr<vsg::Node> root, const std::vector<const vsg::Node*> &spine);
+
+    void invalidate() { _dirty = true; }
+
+    void addGizmo(const vsg::Node *gizmo);
+
+    vsg::LineSegmentIntersector::Intersections intersect(const vsg::PointerEvent &event, const vsg::Camera &camera, uint32_t layers = Scene);
+
+    struct Task
+    {
+        const vsg::Node *node;
+        vsg::NodePath path;
+        std::vector<const vsg::Transform*> transforms;
+        vsg::dbox bounds;
+        bool cull;
+    };
+
+private:
+    void rebuild();
+
+    vsg::ref_ptr<vsg::Node> _root;
+    std::vector<const vsg::Node*> _spine;
+    std::vector<const vsg::Node*> _gizmos;
+
+    std::vector<Task> _tasks;
+
+    bool _dirty = true;
+};
+
+#endif // PICKER_H
@@ -0,0 +1,104 @@
+#include "ProfilerPanel.h"
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    double milliseconds(quint64 us)
+    {
+        return std::round(static_cast<double>(us) / 10.0) / 100.0;
+    }
+
+    //one character per histogram bucket, scaled to the fullest one
+    QString sparkline(const UndoProfiler::Stats &stats)
+    {
+        static const QString levels = QString::fromUtf8(" ▁▂▃▄▅▆▇█");
+        auto peak = *std::max_element(stats.histogram.begin(), stats.histogram.end());
+        QString line;
+        for (auto count : stats.histogram)
+            line.append(levels[peak == 0 ? 0 : static_cast<int>((count * (levels.size() - 1) + peak - 1) / peak)]);
+        return line;
+    }
+}
+
+ProfilerPanel::ProfilerPanel(QWidget *parent) : QWidget(parent)
+  , _table(new QTreeWidget(this))
+  , _traceBox(new QCheckBox(tr("Записывать трассу"), this))
+{
+    _table->setRootIsDecorated(false);
+    _table->setSortingEnabled(true);
+    _table->setHeaderLabels({tr("Действие"), tr("Фаза"), tr("Количество"), tr("Среднее, мс"),
+                             tr("50%, мс"), tr("95%, мс"), tr("Макс., мс"), tr("Распределение")});
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(_table);
+
+    auto buttons = new QHBoxLayout();
+    auto refreshButt = new QPushButton(tr("Обновить"), this);
+    auto resetButt = new QPushButton(tr("Сбросить"), this);
+    buttons->addWidget(_traceBox);
+    buttons->addStretch();
+    buttons->addWidget(refreshButt);
+    buttons->addWidget(resetButt);
+    layout->addLayout(buttons);
+
+    connect(refreshButt, &QPushButton::pressed, this, &ProfilerPanel::refresh);
+    connect(resetButt, &QPushButton::pressed, this, &ProfilerPanel::reset);
+    connect(_traceBox, &QCheckBox::toggled, this, &ProfilerPanel::setTracing);
+}
+
+void ProfilerPanel::refresh()
+{
+    static const QStringList phases = {tr("выполнение"), tr("отмена"), tr("обновление")};
+
+    _table->setSortingEnabled(false);
+    _table->clear();
+    for (const auto &stats : UndoProfiler::instance().stats())
+    {
+        auto item = new QTreeWidgetItem(_table);
+        item->setText(0, stats.name);
+        item->setText(1, phases[stats.phase]);
+        item->setData(2, Qt::DisplayRole, stats.count);
+        item->setData(3, Qt::DisplayRole, milliseconds(stats.total / stats.count));
+        item->setData(4, Qt::DisplayRole, milliseconds(stats.percentile(0.5)));
+        item->setData(5, Qt::DisplayRole, milliseconds(stats.percentile(0.95)));
+        item->setData(6, Qt::DisplayRole, milliseconds(stats.max));
+        item->setText(7, sparkline(stats));
+    }
+    _table->setSortingEnabled(true);
+    _table->sortByColumn(6, Qt::DescendingOrder);
+    _table->header()->resizeSections(QHeaderView::ResizeToContents);
+}
+
+void ProfilerPanel::reset()
+{
+    UndoProfiler::instance().reset();
+    refresh();
+}
+
+void ProfilerPanel::showEvent(QShowEvent *event)
+{
+    refresh();
+    QWidget::showEvent(event);
+}
+
+void ProfilerPanel::setTracing(bool enabled)
+{
+    if(!enabled)
+    {
+        UndoProfiler::instance().setTraceFile({});
+        return;
+    }
+
+    auto path = QFileDialog::getSaveFileName(this, tr("Файл трассы"), {}, tr("Трасса (*.json)"));
+    if(path.isEmpty() || !UndoProfiler::instance().setTraceFile(path))
+    {
+        QSignalBlocker blocker(_traceBox);
+        _traceBox->setChecked(false);
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef PROFILERPANEL_H
+#define PROFILERPANEL_H
+
+#include <QWidget>
+#include <QTreeWidget>
+#include <QCheckBox>
+#include "UndoProfiler.h"
+
+//Debug view of undo and refresh latencies collected by UndoProfiler.
+class ProfilerPanel : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit ProfilerPanel(QWidget *parent = nullptr);
+
+public slots:
+    void refresh();
+    void reset();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private:
+    void setTracing(bool enabled);
+
+    QTreeWidget *_table;
+    QCheckBox *_traceBox;
+};
+
+#endif // PROFILERPANEL_H
@@ -4,6 +4,7 @@
 #include <vsg/utils/ComputeBounds.h>
 #include "sceneobjects.h"
 #include <QSignalBlocker>
+#include <algorithm>
 
 RailsPointEditor::RailsPointEditor(DatabaseManager *database, QWidget *parent) : Tool(database, parent)
     , ui(new Ui::RailsPointEditor)
@@ -14,7 +15,19 @@ RailsPointEditor::RailsPointEditor(DatabaseManager *database, QWidget *parent) :
 
     auto stack = _database->undoStack;
 
-    connect(stack, &QUndoStack::indexChanged, this, &RailsPointEditor::updateData);
+    //rail point edits are lambdas the model does not see, they come as other changes
+    connect(_database->tilesModel, &SceneModel::changed, this, [this](const ChangeSet &changes)
+    {
+        if(_selectedObjects.isEmpty())
+            return;
+        std::vector<ObjectRegistry::ID> ids;
+        ids.reserve(_selectedObjects.size());
+        for (auto object : qAsConst(_selectedObjects))
+            ids.push_back(_database->registry->id(object));
+        std::sort(ids.begin(), ids.end());
+        if(changes.affects(ids))
+            updateData();
+    });
 /*
     connect(ui->inclSpin, &QDoubleSpinBox::valueChanged, this, [stack, this](double d)
     {
@@ -193,6 +206,7 @@ void RailsPointEditor::setSpinEanbled(bool enabled)
 
 void RailsPointEditor::updateData()
 {
+    UndoProfiler::Scope scope("RailsPointEditor::updateData", UndoProfiler::Handler);
     /*
     QSignalBlocker l2(ui->tangSpin);
     QSignalBlocker l3(ui->tiltSpin);
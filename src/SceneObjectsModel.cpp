@@ -8,6 +8,20 @@
 #include <vsg/nodes/LOD.h>
 #include <vsg/app/CompileTraversal.h>
 #include <vsg/io/VSG.h>
+#include <vsg/io/BinaryInput.h>
+#include <vsg/io/BinaryOutput.h>
+#include <vsg/io/ObjectFactory.h>
+#include <vsg/core/Version.h>
+#include <vsg/core/Objects.h>
+#include <unordered_set>
+#include <algorithm>
+#include <memory>
+
+namespace
+{
+    constexpr int FETCH_CHUNK = 512;
+    const QString NODES_MIME_TYPE = "application/x-route-nodes";
+}
 
 SceneModel::SceneModel(vsg::ref_ptr<route::MVCObject> group, vsg::ref_ptr<vsg::Builder> builder, QObject *parent) :
     QAbstractItemModel(parent)
@@ -63,7 +77,29 @@ QModelIndex SceneModel::parent(const QModelIndex &child) const
     if (!grandParent)
         return QModelIndex();
 
-    return createIndex(grandParent->findPos(parent), 0, parent);
+    return createIndex(row(grandParent, parent), 0, parent);
+}
+
+int SceneModel::row(route::MVCObject *parent, const route::MVCObject *node) const
+{
+    //removed nodes leave stale entries for their siblings, so every hit is checked against the tree
+    if(auto it = _rows.find(node); it != _rows.end())
+    {
+        auto cached = it->second;
+        if(cached < parent->childrenCount() && parent->at(cached) == node)
+            return cached;
+    }
+
+    //miss means the siblings have shifted too, refresh all of them in one pass
+    int found = -1;
+    for (int i = 0; i < parent->childrenCount(); ++i)
+    {
+        const route::MVCObject *child = parent->at(i);
+        _rows[child] = i;
+        if(child == node)
+            found = i;
+    }
+    return found;
 }
 
 bool SceneModel::removeRows(int row, int count, const QModelIndex &parent)
@@ -74,8 +110,19 @@ bool SceneModel::removeRows(int row, int count, const QModelIndex &parent)
     if (!parentNode->canAdd())
         return false;
 
+    if(row + count > fetched(parentNode))
+        fetchUntil(parentNode, row + count - 1);
+    auto remaining = fetched(parentNode) - count;
+
     beginRemoveRows(parent, row, row + count - 1);
+    for (int i = row; i < row + count; ++i)
+    {
+        route::MVCObject *child = parentNode->at(i);
+        updateIndices(child, false);
+        forget(child);
+    }
     parentNode->removeChildren(row, count);
+    _fetched[parentNode] = remaining;
     endRemoveRows();
 
     return true;
@@ -83,16 +130,37 @@ bool SceneModel::removeRows(int row, int count, const QModelIndex &parent)
 
 int SceneModel::addNode(const QModelIndex &parent, vsg::ref_ptr<route::MVCObject> loaded)
 {
-    int row = rowCount(parent);
+    return addNodes(parent, {loaded});
+}
 
-    auto parentNode = static_cast<route::MVCObject*>(parent.internalPointer());
+int SceneModel::addNodes(const QModelIndex &parent, const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes)
+{
+    auto parentNode = parent.isValid() ? static_cast<route::MVCObject*>(parent.internalPointer()) : _root.get();
 
-    if (!parentNode->canAdd())
-        return false;
+    if (!parentNode->canAdd() || nodes.empty())
+        return -1;
 
-    beginInsertRows(parent, row, row);
-    parentNode->addChild(loaded);
-    endInsertRows();
+    int row = parentNode->childrenCount();
+    int count = static_cast<int>(nodes.size());
+
+    //appending behind rows that are not fetched yet is invisible to views
+    bool visible = fetched(parentNode) == row;
+
+    if(visible)
+        beginInsertRows(parent, row, row + count - 1);
+    for (int i = 0; i < count; ++i)
+    {
+        parentNode->addChild(nodes[i]);
+        _rows[nodes[i].get()] = row + i;
+        if(_registry)
+            _registry->addTree(nodes[i]);
+        updateIndices(nodes[i], true);
+    }
+    if(visible)
+    {
+        _fetched[parentNode] = row + count;
+        endInsertRows();
+    }
     return row;
 }
 
@@ -107,13 +175,129 @@ void SceneModel::removeNode(const QModelIndex &index, const QModelIndex &parent)
     removeRow(index.row(), parent);
 }
 
+void SceneModel::removeNodes(const QModelIndex &parent, const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes)
+{
+    std::vector<int> rows;
+    rows.reserve(nodes.size());
+    auto parentNode = parent.isValid() ? static_cast<route::MVCObject*>(parent.internalPointer()) : _root.get();
+    for (const auto &node : nodes)
+        rows.push_back(row(parentNode, node));
+    std::sort(rows.begin(), rows.end());
+
+    //one notification per contiguous range, from the end so that earlier rows stay put
+    auto last = rows.size();
+    while (last > 0)
+    {
+        auto first = last - 1;
+        while (first > 0 && rows[first - 1] == rows[first] - 1)
+            --first;
+        removeRows(rows[first], static_cast<int>(last - first), parent);
+        last = first;
+    }
+}
+
 QModelIndex SceneModel::index(const route::MVCObject *node) const
 {
     auto parent = node->parent();
-    if(parent)
-        return createIndex(parent->findPos(node), 0, node);
-    else
+    if(!parent || node == _root.get())
+        return QModelIndex();
+
+    auto position = row(parent, node);
+    if(position < 0 || position >= fetched(parent))
+        return QModelIndex();
+    if(parent != _root.get() && !index(parent).isValid())
+        return QModelIndex();
+
+    return createIndex(position, 0, node);
+}
+
+QModelIndex SceneModel::reveal(const route::MVCObject *node)
+{
+    auto parent = node->parent();
+    if(!parent || node == _root.get())
+        return QModelIndex();
+
+    if(parent != _root.get())
+        reveal(parent);
+
+    auto position = row(parent, node);
+    if(position < 0)
         return QModelIndex();
+    if(position >= fetched(parent))
+        fetchUntil(parent, position);
+
+    return createIndex(position, 0, node);
+}
+
+void SceneModel::reveal(const std::vector<const route::MVCObject*> &nodes)
+{
+    std::unordered_map<route::MVCObject*, int> last;
+    for (auto node : nodes)
+    {
+        auto parent = node ? node->parent() : nullptr;
+        if(!parent || node == _root.get())
+            continue;
+        auto position = row(parent, node);
+        if(position < 0)
+            continue;
+        auto [it, inserted] = last.emplace(parent, position);
+        if(!inserted)
+            it->second = std::max(it->second, position);
+    }
+
+    for (const auto &[parent, position] : last)
+    {
+        if(parent != _root.get())
+            reveal(parent);
+        if(position >= fetched(parent))
+            fetchUntil(parent, position);
+    }
+}
+
+QModelIndex SceneModel::index(ObjectRegistry::ID id) const
+{
+    auto node = _registry ? _registry->object(id) : nullptr;
+    return node ? index(node) : QModelIndex();
+}
+
+int SceneModel::fetched(route::MVCObject *parent) const
+{
+    auto children = parent->childrenCount();
+    auto it = _fetched.try_emplace(parent, std::min(children, FETCH_CHUNK)).first;
+    //the tree may have been changed past the model
+    return std::min(it->second, children);
+}
+
+void SceneModel::fetchUntil(route::MVCObject *parent, int row)
+{
+    auto first = fetched(parent);
+    auto last = std::min(row, parent->childrenCount() - 1);
+    if(last < first)
+        return;
+
+    auto parentIndex = parent == _root.get() ? QModelIndex() : index(parent);
+    //views have not seen the parent yet, so there is nobody to notify
+    if(parent != _root.get() && !parentIndex.isValid())
+    {
+        _fetched[parent] = last + 1;
+        return;
+    }
+
+    beginInsertRows(parentIndex, first, last);
+    _fetched[parent] = last + 1;
+    endInsertRows();
+}
+
+bool SceneModel::canFetchMore(const QModelIndex &parent) const
+{
+    auto parentNode = parent.isValid() ? static_cast<route::MVCObject*>(parent.internalPointer()) : _root.get();
+    return fetched(parentNode) < parentNode->childrenCount();
+}
+
+void SceneModel::fetchMore(const QModelIndex &parent)
+{
+    auto parentNode = parent.isValid() ? static_cast<route::MVCObject*>(parent.internalPointer()) : _root.get();
+    fetchUntil(parentNode, fetched(parentNode) + FETCH_CHUNK - 1);
 }
 
 int SceneModel::columnCount ( const QModelIndex & /*parent = QModelIndex()*/ ) const
@@ -129,59 +313,241 @@ Qt::DropActions SceneModel::supportedDropActions() const
 QStringList SceneModel::mimeTypes() const
 {
     QStringList types;
-    types << "text/plain";// << "application/octet-stream";
+    types << NODES_MIME_TYPE << "text/plain";
     return types;
 }
 
 QMimeData *SceneModel::mimeData(const QModelIndexList &indexes) const
 {
-    if(indexes.count() != 1)
+    std::unordered_set<const route::MVCObject*> selected;
+    for (const auto &index : indexes)
+    {
+        if (index.isValid())
+            selected.insert(static_cast<route::MVCObject*>(index.internalPointer()));
+    }
+
+    //children of dragged groups go with them
+    std::vector<std::pair<std::vector<int>, const route::MVCObject*>> ordered;
+    for (auto node : selected)
+    {
+        bool nested = false;
+        for (auto parent = node->parent(); parent && !nested; parent = parent->parent())
+            nested = selected.count(parent) != 0;
+        if(nested)
+            continue;
+
+        //rows from the root down, so that nodes keep the order they have in the tree
+        std::vector<int> path;
+        for (auto child = node; child->parent(); child = child->parent())
+            path.push_back(row(child->parent(), child));
+        std::reverse(path.begin(), path.end());
+        ordered.emplace_back(std::move(path), node);
+    }
+    if(ordered.empty())
         return 0;
+    std::sort(ordered.begin(), ordered.end());
 
-    vsg::VSG io;
-    _options->extensionHint = "vsgt";
+    std::vector<vsg::ref_ptr<route::MVCObject>> nodes;
+    nodes.reserve(ordered.size());
+    for (const auto &entry : ordered)
+        nodes.emplace_back(const_cast<route::MVCObject*>(entry.second));
 
-    std::ostringstream oss;
+    return new SceneMimeData(this, nodes);
+}
 
-    if (indexes.at(0).isValid()) {
-        if(auto node = static_cast<route::MVCObject*>(indexes.at(0).internalPointer()); node)
-        {
-            io.write(node, oss, _options);
-        }
-    } else
+QMimeData *SceneModel::copyData(const QModelIndexList &indexes) const
+{
+    std::unique_ptr<QMimeData> dragged(mimeData(indexes));
+    if(!dragged)
         return 0;
 
-    QMimeData *mimeData = new QMimeData();
-    mimeData->setText(oss.str().c_str());
-    return mimeData;
+    //all nodes are written in one pass, so models shared between them are stored once
+    auto data = new QMimeData();
+    data->setData(NODES_MIME_TYPE, dragged->data(NODES_MIME_TYPE));
+    return data;
 }
 
 bool SceneModel::dropMimeData(const QMimeData *data, Qt::DropAction action,
                                int row, int column, const QModelIndex &parent)
 {
-    if (!data->hasText() || column > 0 || !parent.isValid())
+    if (column > 0 || !parent.isValid())
         return false;
     else if (action == Qt::IgnoreAction)
         return true;
 
-    std::istringstream iss(data->text().toStdString());
+    Q_ASSERT(_undoStack != nullptr);
 
-    vsg::VSG io;
+    auto target = static_cast<route::MVCObject*>(parent.internalPointer());
+
+    //nodes dragged inside the editor are moved as they are
+    auto sceneData = qobject_cast<const SceneMimeData*>(data);
+    if(sceneData && sceneData->model() == this && action == Qt::MoveAction)
+    {
+        if(!target->canAdd())
+            return false;
+        for (const auto &node : sceneData->nodes())
+        {
+            for (auto ancestor = target; ancestor; ancestor = ancestor->parent())
+                if(ancestor == node)
+                    return false;
+        }
+        _undoStack->push(new MoveNodes(this, sceneData->nodes(), target));
 
-    auto object = io.read(iss, _options);
-    auto node = object.cast<route::MVCObject>();
-    if(!node)
+        //the move is done and undoable, reporting success would make the view remove the source rows on its own
         return false;
+    }
 
-    node->accept(*_compile);
+    std::vector<vsg::ref_ptr<route::MVCObject>> nodes;
+    if(data->hasFormat(NODES_MIME_TYPE))
+        nodes = readNodes(data->data(NODES_MIME_TYPE), "vsgb");
+    else if(data->hasText())
+        nodes = readNodes(data->text().toUtf8(), "vsgt");
 
-    Q_ASSERT(_undoStack != nullptr);
+    if(nodes.empty() || !target->canAdd())
+        return false;
 
-    _undoStack->push(new AddSceneObject(this, parent, node));
+    compile(nodes);
+
+    if(nodes.size() == 1)
+        _undoStack->push(new AddSceneObject(this, parent, nodes.front()));
+    else
+        _undoStack->push(new AddSceneObjects(this, target, nodes));
 
     return true;
 }
 
+void SceneModel::compile(const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes) const
+{
+    //models without a builder, e.g. in benchmarks, have nothing to compile with
+    if(!_compile)
+        return;
+    for (const auto &node : nodes)
+        node->accept(*_compile);
+}
+
+std::vector<vsg::ref_ptr<route::MVCObject>> SceneModel::readNodes(const QByteArray &data, const vsg::Path &extension) const
+{
+    auto options = _options ? vsg::Options::create(*_options) : vsg::Options::create();
+    options->extensionHint = extension;
+
+    std::istringstream iss(std::string(data.constData(), static_cast<size_t>(data.size())));
+
+    vsg::VSG io;
+    auto object = io.read(iss, options);
+
+    std::vector<vsg::ref_ptr<route::MVCObject>> nodes;
+    if(auto objects = object.cast<vsg::Objects>(); objects)
+    {
+        for (const auto &child : objects->children)
+            if(auto node = child.cast<route::MVCObject>(); node)
+                nodes.push_back(node);
+    }
+    else if(auto node = object.cast<route::MVCObject>(); node)
+        nodes.push_back(node);
+    return nodes;
+}
+
+SceneMimeData::SceneMimeData(const SceneModel *model, const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes)
+    : QMimeData()
+    , _model(model)
+    , _nodes(nodes)
+{
+}
+
+QStringList SceneMimeData::formats() const
+{
+    return {NODES_MIME_TYPE, "text/plain"};
+}
+
+bool SceneMimeData::hasFormat(const QString &mimeType) const
+{
+    return formats().contains(mimeType);
+}
+
+QVariant SceneMimeData::retrieveData(const QString &mimeType, QMetaType type) const
+{
+    if(mimeType == NODES_MIME_TYPE)
+    {
+        if(_binary.isEmpty())
+            _binary = write("vsgb");
+        return _binary;
+    }
+    else if(mimeType == "text/plain")
+    {
+        if(_text.isEmpty())
+            _text = QString::fromUtf8(write("vsgt"));
+        return _text;
+    }
+    return QMimeData::retrieveData(mimeType, type);
+}
+
+QByteArray SceneMimeData::write(const vsg::Path &extension) const
+{
+    return _model->writeNodes(_nodes, extension);
+}
+
+QByteArray SceneModel::writeNodes(const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes, const vsg::Path &extension) const
+{
+    auto options = _options ? vsg::Options::create(*_options) : vsg::Options::create();
+    options->extensionHint = extension;
+
+    vsg::ref_ptr<vsg::Object> object;
+    if(nodes.size() == 1)
+        object = nodes.front();
+    else
+    {
+        auto objects = vsg::Objects::create();
+        objects->children.assign(nodes.begin(), nodes.end());
+        object = objects;
+    }
+
+    std::ostringstream oss;
+    vsg::VSG io;
+    io.write(object, oss, options);
+
+    auto data = oss.str();
+    return QByteArray(data.data(), static_cast<qsizetype>(data.size()));
+}
+
+QByteArray SceneModel::packNodes(const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes, const std::vector<vsg::ref_ptr<vsg::Object>> &shared) const
+{
+    auto objects = vsg::Objects::create();
+    objects->children.assign(nodes.begin(), nodes.end());
+
+    std::ostringstream oss;
+    vsg::BinaryOutput output(oss, _options);
+    output.version = vsgGetVersion();
+    //shared objects take IDs from 1 on, so the stream only refers to them, new objects follow
+    uint32_t id = 1;
+    for (const auto &object : shared)
+        output.objectIDMap[object.get()] = id++;
+    output.objectID = id;
+    output.writeObject("Root", objects);
+
+    auto data = oss.str();
+    return QByteArray(data.data(), static_cast<qsizetype>(data.size()));
+}
+
+std::vector<vsg::ref_ptr<route::MVCObject>> SceneModel::unpackNodes(const QByteArray &data, const std::vector<vsg::ref_ptr<vsg::Object>> &shared) const
+{
+    std::istringstream iss(std::string(data.constData(), static_cast<size_t>(data.size())));
+    vsg::BinaryInput input(iss, vsg::ObjectFactory::instance(), _options);
+    input.version = vsgGetVersion();
+    //the same IDs as in packNodes()
+    uint32_t id = 1;
+    for (const auto &object : shared)
+        input.objectIDMap[id++] = object;
+
+    std::vector<vsg::ref_ptr<route::MVCObject>> nodes;
+    if(auto objects = input.readObject("Root").cast<vsg::Objects>(); objects)
+    {
+        for (const auto &child : objects->children)
+            if(auto node = child.cast<route::MVCObject>(); node)
+                nodes.push_back(node);
+    }
+    return nodes;
+}
+
 bool SceneModel::canAdd(const QModelIndex &index) const
 {
     if(!index.isValid())
@@ -189,21 +555,15 @@ bool SceneModel::canAdd(const QModelIndex &index) const
     auto node = static_cast<route::MVCObject*>(index.internalPointer());
     return node->canAdd();
 }
-/*
-void SceneModel::fetchMore(const QModelIndex &parent)
-{
-    beginInsertRows(parent, 0, rowCount(parent));
-    endInsertRows();
-}
-*/
-
 int SceneModel::rowCount(const QModelIndex &parent) const
 {
     if (!parent.isValid()) {
-        return _root->childrenCount();
+        return fetched(_root);
     }
+    if (parent.column() != 0)
+        return 0;
     auto parentNode = static_cast<route::MVCObject*>(parent.internalPointer());
-    return parentNode->childrenCount();
+    return fetched(parentNode);
 }
 QVariant SceneModel::data(const QModelIndex &index, int role) const
 {
@@ -218,7 +578,7 @@ QVariant SceneModel::data(const QModelIndex &index, int role) const
     case Type:
     {
         if (role == Qt::DisplayRole)
-            return nodeInfo->className();
+            return className(nodeInfo);
         else if(role == Qt::CheckStateRole && index.parent().isValid())
         {
         }
@@ -228,7 +588,7 @@ QVariant SceneModel::data(const QModelIndex &index, int role) const
     {
         if (role == Qt::DisplayRole || role == Qt::EditRole)
         {
-            return nodeInfo->getName();
+            return name(nodeInfo);
         }
         break;
     }
@@ -245,6 +605,158 @@ QVariant SceneModel::data(const QModelIndex &index, int role) const
     return QVariant();
 }
 
+void SceneModel::setName(route::MVCObject *node, const QString &name)
+{
+    node->setName(name);
+    _names[node] = name;
+    if(_nameIndex && _registry)
+        _nameIndex->set(_registry->slot(node), name);
+
+    //rows that are not fetched yet are unknown to views
+    auto parent = node->parent();
+    if(!parent || node == _root.get())
+        return;
+    if(_registry)
+        changes().renamed.push_back(_registry->id(node));
+
+    auto position = row(parent, node);
+    if(position < fetched(parent))
+    {
+        auto changed = createIndex(position, Name, node);
+        emit dataChanged(changed, changed, {Qt::DisplayRole, Qt::EditRole});
+    }
+}
+
+void SceneModel::setTransforms(const std::vector<ObjectRegistry::ID> &ids, const std::vector<vsg::dvec3> &positions, const std::vector<vsg::dquat> &rotations)
+{
+    Q_ASSERT(ids.size() == positions.size() && ids.size() == rotations.size());
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        if(auto object = _registry->object(ids[i]); object)
+        {
+            object->setPosition(positions[i]);
+            object->setRotation(rotations[i]);
+        }
+    }
+    auto &transformed = changes().transformed;
+    transformed.insert(transformed.end(), ids.begin(), ids.end());
+}
+
+void SceneModel::setUndoStack(QUndoStack *stack)
+{
+    if(_undoStack)
+        disconnect(_undoStack, nullptr, this, nullptr);
+    _undoStack = stack;
+    if(!stack)
+        return;
+    _stackIndex = stack->index();
+    connect(stack, &QUndoStack::indexChanged, this, &SceneModel::stepDone);
+}
+
+ChangeSet &SceneModel::changes()
+{
+    if(!_publishQueued)
+    {
+        _publishQueued = true;
+        QMetaObject::invokeMethod(this, &SceneModel::publish, Qt::QueuedConnection);
+    }
+    return _changes;
+}
+
+void SceneModel::stepDone(int index)
+{
+    //a merged step keeps the index, the command before it is the one that changed
+    auto first = std::min(index, _stackIndex);
+    auto last = std::max(index, _stackIndex);
+    if(first == last && first > 0)
+        --first;
+    _stackIndex = index;
+
+    //the stack has been cleared or the steps are unknown
+    if(last > _undoStack->count() || first == last)
+        _changes.other = true;
+    for (auto i = first; i < last && !_changes.other; ++i)
+        if(!published(_undoStack->command(i)))
+            _changes.other = true;
+    publish();
+}
+
+void SceneModel::publish()
+{
+    _publishQueued = false;
+    if(_changes.empty())
+        return;
+
+    ChangeSet changes;
+    std::swap(changes, _changes);
+    changes.normalize();
+    emit changed(changes);
+}
+
+bool SceneModel::published(const QUndoCommand *command)
+{
+    if(auto publishing = dynamic_cast<const PublishedCommand*>(command); publishing)
+        return publishing->published();
+    //macros publish when all of their steps do
+    if(command->childCount() == 0)
+        return false;
+    for (int i = 0; i < command->childCount(); ++i)
+        if(!published(command->child(i)))
+            return false;
+    return true;
+}
+
+void SceneModel::updateIndices(route::MVCObject *node, bool present)
+{
+    if(!_registry)
+        return;
+    auto &changed = present ? changes().added : changes().removed;
+    changed.push_back(_registry->id(node));
+    if(_nameIndex)
+    {
+        if(present)
+            _nameIndex->set(_registry->slot(node), node->getName());
+        else
+            _nameIndex->remove(_registry->slot(node));
+    }
+    if(_facetIndex)
+    {
+        if(present)
+            _facetIndex->add(node);
+        else
+            _facetIndex->remove(node);
+    }
+    for (int i = 0; i < node->childrenCount(); ++i)
+        updateIndices(node->at(i), present);
+}
+
+void SceneModel::forget(route::MVCObject *node)
+{
+    _rows.erase(node);
+    _fetched.erase(node);
+    _names.erase(node);
+    for (int i = 0; i < node->childrenCount(); ++i)
+        forget(node->at(i));
+}
+
+const QString &SceneModel::name(const route::MVCObject *node) const
+{
+    auto it = _names.find(node);
+    if(it == _names.end())
+        it = _names.emplace(node, node->getName()).first;
+    return it->second;
+}
+
+const QString &SceneModel::className(const route::MVCObject *node) const
+{
+    //className() points to a string literal of the class, so the pointer identifies it
+    const char *key = node->className();
+    auto it = _classNames.find(key);
+    if(it == _classNames.end())
+        it = _classNames.emplace(key, QString::fromLatin1(key)).first;
+    return it->second;
+}
+
 bool SceneModel::hasChildren(const QModelIndex &parent) const
 {
     if (parent.isValid()) {
@@ -267,12 +779,11 @@ bool SceneModel::setData(const QModelIndex &index, const QVariant &value, int ro
     if (index.column() == Name)
     {
         QString newName = value.toString();
-        QUndoCommand *command = new RenameObject(nodeInfo, newName);
+        QUndoCommand *command = new RenameObject(this, nodeInfo, newName);
 
         Q_ASSERT(_undoStack != nullptr);
         _undoStack->push(command);
 
-        emit dataChanged(index, index.sibling(index.row(), ColumnCount));
         return true;
     }
     else if (index.column() == Option)
@@ -3,8 +3,14 @@
 
 #include <QUndoStack>
 #include <QAbstractItemModel>
+#include <QMimeData>
 #include "sceneobjects.h"
+#include "ObjectRegistry.h"
+#include "NameIndex.h"
+#include "FacetIndex.h"
+#include "ChangeSet.h"
 #include <vsg/utils/Builder.h>
+#include <unordered_map>
 
 class SceneModel : public QAbstractItemModel
 {
@@ -37,27 +43,88 @@ public:
 
     QMimeData *mimeData(const QModelIndexList &indexes) const;
 
+    //snapshot of the nodes for the clipboard
+    QMimeData *copyData(const QModelIndexList &indexes) const;
+
     //bool canDropMimeData(const QMimeData *data, Qt::DropAction action, int row, int column, const QModelIndex &parent) const;
 
     bool dropMimeData(const QMimeData *data, Qt::DropAction action, int row, int column, const QModelIndex &parent);
 
     bool canAdd( const QModelIndex & index ) const;
 
+    //renames through the model, so that the cached name and the views are updated
+    void setName(route::MVCObject *node, const QString &name);
+
+    //serialised subtrees, for the clipboard and compacted undo history
+    QByteArray writeNodes(const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes, const vsg::Path &extension) const;
+    std::vector<vsg::ref_ptr<route::MVCObject>> readNodes(const QByteArray &data, const vsg::Path &extension) const;
+    //in-session payload, objects in shared are written as references and bound to the same instances on read
+    QByteArray packNodes(const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes, const std::vector<vsg::ref_ptr<vsg::Object>> &shared) const;
+    std::vector<vsg::ref_ptr<route::MVCObject>> unpackNodes(const QByteArray &data, const std::vector<vsg::ref_ptr<vsg::Object>> &shared) const;
+    void compile(const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes) const;
+
+    //moves and rotates registered objects in one pass, arrays are parallel to ids
+    void setTransforms(const std::vector<ObjectRegistry::ID> &ids, const std::vector<vsg::dvec3> &positions, const std::vector<vsg::dquat> &rotations);
+
     int addNode(const QModelIndex &parent, vsg::ref_ptr<route::MVCObject> loaded);
+    int addNodes(const QModelIndex &parent, const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes);
+    void removeNodes(const QModelIndex &parent, const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes);
 
     QModelIndex removeNode(const QModelIndex &index);
     void removeNode(const QModelIndex &index, const QModelIndex &parent);
 
+    //lookups only, the index is invalid while the node or one of its ancestors is not fetched
     QModelIndex index(const route::MVCObject *node) const;
+    QModelIndex index(ObjectRegistry::ID id) const;
+
+    //fetches the rows down to the node, for indexes that are given to views or change the tree
+    QModelIndex reveal(const route::MVCObject *node);
+    //fetches every parent once, up to the last of its nodes
+    void reveal(const std::vector<const route::MVCObject*> &nodes);
 
     bool hasChildren(const QModelIndex &parent) const;
 
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
+
     vsg::ref_ptr<route::MVCObject> getRoot() { return _root; }
 
-    void setUndoStack(QUndoStack *stack) { _undoStack = stack; }
+    void setUndoStack(QUndoStack *stack);
+    void setRegistry(vsg::ref_ptr<ObjectRegistry> registry) { _registry = registry; }
+    void setNameIndex(vsg::ref_ptr<NameIndex> index) { _nameIndex = index; }
+    void setFacetIndex(vsg::ref_ptr<FacetIndex> index) { _facetIndex = index; }
+
+signals:
+    //once per undo step, and once per event loop pass for changes made outside of the stack
+    void changed(const ChangeSet &changes);
+
+private slots:
+    void stepDone(int index);
+    void publish();
 
 private:
 
+    //row of the node in its parent, taken from the cache when it is still valid
+    int row(route::MVCObject *parent, const route::MVCObject *node) const;
+
+    //keeps the name and facet indices and the pending change set in step with the tree
+    void updateIndices(route::MVCObject *node, bool present);
+    //drops the cached rows, counts and names of a removed subtree, its addresses may be reused
+    void forget(route::MVCObject *node);
+
+    //starts the pending change set, publishing is queued in case no undo step follows
+    ChangeSet &changes();
+    static bool published(const QUndoCommand *command);
+
+    //display strings, so that repainting does not build new ones
+    const QString &name(const route::MVCObject *node) const;
+    const QString &className(const route::MVCObject *node) const;
+
+
+    //children of large groups are exposed to views in chunks
+    int fetched(route::MVCObject *parent) const;
+    void fetchUntil(route::MVCObject *parent, int row);
+
     enum Columns
         {
             Type,
@@ -71,6 +138,44 @@ private:
     vsg::ref_ptr<vsg::Options> _options;
 
     QUndoStack *_undoStack;
+    vsg::ref_ptr<ObjectRegistry> _registry;
+    vsg::ref_ptr<NameIndex> _nameIndex;
+    vsg::ref_ptr<FacetIndex> _facetIndex;
+
+    ChangeSet _changes;
+    bool _publishQueued = false;
+    int _stackIndex = 0;
+
+    mutable std::unordered_map<const route::MVCObject*, int> _rows;
+    mutable std::unordered_map<const route::MVCObject*, int> _fetched;
+    mutable std::unordered_map<const route::MVCObject*, QString> _names;
+    mutable std::unordered_map<const char*, QString> _classNames;
+};
+
+//carries the dragged nodes themselves, they are serialised only when another application asks for them
+class SceneMimeData : public QMimeData
+{
+    Q_OBJECT
+public:
+    SceneMimeData(const SceneModel *model, const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes);
+
+    const SceneModel *model() const { return _model; }
+    const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes() const { return _nodes; }
+
+    QStringList formats() const override;
+    bool hasFormat(const QString &mimeType) const override;
+
+protected:
+    QVariant retrieveData(const QString &mimeType, QMetaType type) const override;
+
+private:
+    QByteArray write(const vsg::Path &extension) const;
+
+    const SceneModel *_model;
+    std::vector<vsg::ref_ptr<route::MVCObject>> _nodes;
+
+    mutable QByteArray _binary;
+    mutable QString _text;
 };
 
 #endif // SCENEMODEL_H
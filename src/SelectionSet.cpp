@@ -0,0 +1,85 @@
+#include "SelectionSet.h"
+#include <algorithm>
+#include <iterator>
+
+bool SelectionSet::contains(ID id) const
+{
+    return std::binary_search(_ids.begin(), _ids.end(), id);
+}
+
+SelectionSet::Delta SelectionSet::add(std::vector<ID> ids)
+{
+    auto lead = ids.empty() ? ObjectRegistry::NULL_ID : ids.front();
+    normalize(ids);
+
+    Delta delta;
+    std::set_difference(ids.begin(), ids.end(), _ids.begin(), _ids.end(), std::back_inserter(delta.selected));
+    if(delta.selected.empty())
+        return delta;
+
+    std::vector<ID> merged;
+    merged.reserve(_ids.size() + delta.selected.size());
+    std::merge(_ids.begin(), _ids.end(), delta.selected.begin(), delta.selected.end(), std::back_inserter(merged));
+    _ids.swap(merged);
+
+    if(_front == ObjectRegistry::NULL_ID)
+        _front = lead;
+    updateFront();
+    return delta;
+}
+
+SelectionSet::Delta SelectionSet::subtract(std::vector<ID> ids)
+{
+    normalize(ids);
+
+    Delta delta;
+    std::set_intersection(_ids.begin(), _ids.end(), ids.begin(), ids.end(), std::back_inserter(delta.deselected));
+    if(delta.deselected.empty())
+        return delta;
+
+    std::vector<ID> remaining;
+    remaining.reserve(_ids.size() - delta.deselected.size());
+    std::set_difference(_ids.begin(), _ids.end(), delta.deselected.begin(), delta.deselected.end(), std::back_inserter(remaining));
+    _ids.swap(remaining);
+
+    updateFront();
+    return delta;
+}
+
+SelectionSet::Delta SelectionSet::invert(std::vector<ID> universe)
+{
+    normalize(universe);
+
+    Delta delta;
+    std::set_difference(universe.begin(), universe.end(), _ids.begin(), _ids.end(), std::back_inserter(delta.selected));
+    delta.deselected.swap(_ids);
+    _ids = delta.selected;
+
+    _front = ObjectRegistry::NULL_ID;
+    updateFront();
+    return delta;
+}
+
+SelectionSet::Delta SelectionSet::clear()
+{
+    Delta delta;
+    delta.deselected.swap(_ids);
+    _front = ObjectRegistry::NULL_ID;
+    return delta;
+}
+
+void SelectionSet::normalize(std::vector<ID> &ids)
+{
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    //objects that are not registered can not be selected
+    if(!ids.empty() && ids.front() == ObjectRegistry::NULL_ID)
+        ids.erase(ids.begin());
+}
+
+void SelectionSet::updateFront()
+{
+    if(_front != ObjectRegistry::NULL_ID && contains(_front))
+        return;
+    _front = _ids.empty() ? ObjectRegistry::NULL_ID : _ids.front();
+}
@@ -0,0 +1,46 @@
+#ifndef SELECTIONSET_H
+#define SELECTIONSET_H
+
+#include "ObjectRegistry.h"
+#include <vector>
+
+//Selected objects as sorted registry IDs.
+//Bulk operations merge sorted arrays and report which objects changed,
+//so highlights and views are updated once per operation instead of once per object.
+class SelectionSet
+{
+public:
+    using ID = ObjectRegistry::ID;
+
+    struct Delta
+    {
+        std::vector<ID> selected;
+        std::vector<ID> deselected;
+
+        bool empty() const { return selected.empty() && deselected.empty(); }
+    };
+
+    bool empty() const { return _ids.empty(); }
+    size_t size() const { return _ids.size(); }
+    bool contains(ID id) const;
+    const std::vector<ID> &ids() const { return _ids; }
+
+    //the object that leads relative edits, the first one added that is still selected
+    ID front() const { return _front; }
+
+    //ids may come in any order, the first of them leads when nothing was selected
+    Delta add(std::vector<ID> ids);
+    Delta subtract(std::vector<ID> ids);
+    //selects the objects of the universe that are not selected and deselects all others
+    Delta invert(std::vector<ID> universe);
+    Delta clear();
+
+private:
+    static void normalize(std::vector<ID> &ids);
+    void updateFront();
+
+    std::vector<ID> _ids;
+    ID _front = ObjectRegistry::NULL_ID;
+};
+
+#endif // SELECTIONSET_H
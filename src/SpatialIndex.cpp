@@ -0,0 +1,199 @@
+#include "SpatialIndex.h"
+#include <vsg/utils/ComputeBounds.h>
+#include <algorithm>
+#include <array>
+
+namespace
+{
+    constexpr uint32_t LEAF_SIZE = 8;
+
+    enum Containment
+    {
+        Outside,
+        Intersects,
+        Inside
+    };
+
+    double distance(const vsg::dvec4 &plane, const vsg::dvec3 &point)
+    {
+        return plane.x * point.x + plane.y * point.y + plane.z * point.z + plane.w;
+    }
+
+    Containment classify(const vsg::dbox &box, const SpatialIndex::Polytope &polytope)
+    {
+        bool inside = true;
+        for (const auto &plane : polytope)
+        {
+            vsg::dvec3 outer(plane.x > 0.0 ? box.max.x : box.min.x,
+                             plane.y > 0.0 ? box.max.y : box.min.y,
+                             plane.z > 0.0 ? box.max.z : box.min.z);
+            if(distance(plane, outer) < 0.0)
+                return Outside;
+
+            vsg::dvec3 inner(plane.x > 0.0 ? box.min.x : box.max.x,
+                             plane.y > 0.0 ? box.min.y : box.max.y,
+                             plane.z > 0.0 ? box.min.z : box.max.z);
+            if(distance(plane, inner) < 0.0)
+                inside = false;
+        }
+        return inside ? Inside : Intersects;
+    }
+
+    vsg::dvec4 makePlane(const vsg::dvec3 &a, const vsg::dvec3 &b, const vsg::dvec3 &c, const vsg::dvec3 &inner)
+    {
+        auto normal = vsg::normalize(vsg::cross(b - a, c - a));
+        vsg::dvec4 plane(normal.x, normal.y, normal.z, -vsg::dot(normal, a));
+        if(distance(plane, inner) < 0.0)
+            plane = vsg::dvec4(-plane.x, -plane.y, -plane.z, -plane.w);
+        return plane;
+    }
+}
+
+SpatialIndex::SpatialIndex(vsg::ref_ptr<route::MVCObject> root)
+    : _root(root)
+{
+}
+
+std::vector<SpatialIndex::Entry> SpatialIndex::intersect(const Polytope &polytope)
+{
+    if(_dirty)
+        rebuild();
+
+    std::vector<Entry> result;
+    if(_nodes.empty())
+        return result;
+
+    std::vector<uint32_t> stack{0};
+    while (!stack.empty())
+    {
+        auto index = stack.back();
+        stack.pop_back();
+
+        const auto &node = _nodes[index];
+        auto containment = classify(node.bounds, polytope);
+        if(containment == Outside)
+            continue;
+
+        if(containment == Inside || node.right == 0)
+        {
+            for (auto i = node.first; i < node.first + node.count; ++i)
+            {
+                if(containment == Inside || classify(_entries[i].bounds, polytope) != Outside)
+                    result.push_back(_entries[i]);
+            }
+            continue;
+        }
+        stack.push_back(node.right);
+        stack.push_back(index + 1);
+    }
+    return result;
+}
+
+SpatialIndex::Polytope SpatialIndex::screenPolytope(const vsg::Camera &camera, const vsg::dvec2 &min, const vsg::dvec2 &max)
+{
+    auto viewport = camera.getViewport();
+    auto inverse = vsg::inverse(camera.projectionMatrix->transform() * camera.viewMatrix->transform());
+
+    auto unproject = [&](double x, double y, double z)
+    {
+        vsg::dvec4 ndc((x - viewport.x) / viewport.width * 2.0 - 1.0, (y - viewport.y) / viewport.height * 2.0 - 1.0, z, 1.0);
+        auto world = inverse * ndc;
+        return vsg::dvec3(world.x, world.y, world.z) / world.w;
+    };
+
+    //depth range is [0, 1] whether or not the projection uses reversed depth
+    std::array<vsg::dvec3, 8> corners{
+        unproject(min.x, min.y, 1.0), unproject(max.x, min.y, 1.0), unproject(max.x, max.y, 1.0), unproject(min.x, max.y, 1.0),
+        unproject(min.x, min.y, 0.0), unproject(max.x, min.y, 0.0), unproject(max.x, max.y, 0.0), unproject(min.x, max.y, 0.0)};
+
+    vsg::dvec3 inner;
+    for (const auto &corner : corners)
+        inner += corner;
+    inner /= static_cast<double>(corners.size());
+
+    return {makePlane(corners[0], corners[1], corners[2], inner),
+            makePlane(corners[4], corners[5], corners[6], inner),
+            makePlane(corners[0], corners[1], corners[5], inner),
+            makePlane(corners[1], corners[2], corners[6], inner),
+            makePlane(corners[2], corners[3], corners[7], inner),
+            makePlane(corners[3], corners[0], corners[4], inner)};
+}
+
+vsg::dvec2 SpatialIndex::project(const vsg::Camera &camera, const vsg::dvec3 &world)
+{
+    auto viewport = camera.getViewport();
+    auto clip = camera.projectionMatrix->transform() * (camera.viewMatrix->transform() * vsg::dvec4(world, 1.0));
+    return {viewport.x + (clip.x / clip.w + 1.0) * 0.5 * viewport.width,
+            viewport.y + (clip.y / clip.w + 1.0) * 0.5 * viewport.height};
+}
+
+void SpatialIndex::rebuild()
+{
+    _entries.clear();
+    _nodes.clear();
+
+    collect(_root);
+
+    if(!_entries.empty())
+        build(0, static_cast<uint32_t>(_entries.size()));
+
+    _dirty = false;
+}
+
+void SpatialIndex::collect(route::MVCObject *group)
+{
+    for (int i = 0; i < group->childrenCount(); ++i)
+    {
+        auto child = group->at(i);
+        if(auto object = child->cast<route::SceneObject>(); object)
+        {
+            vsg::ComputeBounds computeBounds;
+            computeBounds.matrixStack.push_back(group->getWorldTransform());
+            object->accept(computeBounds);
+
+            auto bounds = computeBounds.bounds;
+            if(!bounds.valid())
+            {
+                auto position = object->getWorldTransform()[3];
+                bounds.add(vsg::dvec3(position.x, position.y, position.z));
+            }
+            _entries.push_back({object, bounds});
+        }
+        collect(child);
+    }
+}
+
+uint32_t SpatialIndex::build(uint32_t first, uint32_t count)
+{
+    auto index = static_cast<uint32_t>(_nodes.size());
+    _nodes.push_back({});
+
+    vsg::dbox bounds;
+    vsg::dbox centers;
+    for (auto i = first; i < first + count; ++i)
+    {
+        const auto &entry = _entries[i].bounds;
+        bounds.add(entry);
+        centers.add((entry.min + entry.max) * 0.5);
+    }
+    _nodes[index] = {bounds, first, count, 0};
+
+    if(count <= LEAF_SIZE)
+        return index;
+
+    auto extent = centers.max - centers.min;
+    int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+    auto begin = _entries.begin() + first;
+    auto half = count / 2;
+    std::nth_element(begin, begin + half, begin + count, [axis](const Entry &lhs, const Entry &rhs)
+    {
+        return lhs.bounds.min[axis] + lhs.bounds.max[axis] < rhs.bounds.min[axis] + rhs.bounds.max[axis];
+    });
+
+    build(first, half);
+    auto right = build(first + half, count - half);
+    _nodes[index].right = right;
+
+    return index;
+}
@@ -0,0 +1,51 @@
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include "sceneobjects.h"
+#include <vsg/maths/box.h>
+#include <vsg/app/Camera.h>
+
+//BVH over world bounds of scene objects, rebuilt lazily after the scene has changed
+class SpatialIndex : public vsg::Inherit<vsg::Object, SpatialIndex>
+{
+public:
+    //planes as (normal, distance), points inside have non-negative distance
+    using Polytope = std::vector<vsg::dvec4>;
+
+    struct Entry
+    {
+        route::SceneObject *object;
+        vsg::dbox bounds;
+    };
+
+    explicit SpatialIndex(vsg::ref_ptr<route::MVCObject> root);
+
+    void invalidate() { _dirty = true; }
+
+    std::vector<Entry> intersect(const Polytope &polytope);
+
+    static Polytope screenPolytope(const vsg::Camera &camera, const vsg::dvec2 &min, const vsg::dvec2 &max);
+    static vsg::dvec2 project(const vsg::Camera &camera, const vsg::dvec3 &world);
+
+private:
+    struct Node
+    {
+        vsg::dbox bounds;
+        uint32_t first;
+        uint32_t count;
+        uint32_t right; //0 for leaves, left child is always next to its parent
+    };
+
+    void rebuild();
+    void collect(route::MVCObject *group);
+    uint32_t build(uint32_t first, uint32_t count);
+
+    vsg::ref_ptr<route::MVCObject> _root;
+
+    std::vector<Entry> _entries;
+    std::vector<Node> _nodes;
+
+    bool _dirty = true;
+};
+
+#endif // SPATIALINDEX_H
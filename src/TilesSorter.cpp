@@ -1,19 +1,255 @@
 #include "TilesSorter.h"
+#include "SceneObjectsModel.h"
+#include <QtConcurrent>
 
 TilesSorter::TilesSorter(QObject *parent) : QSortFilterProxyModel(parent)
+    , _serial(std::make_shared<std::atomic<uint64_t>>(0))
 {
 }
 
+void TilesSorter::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    if(auto previous = this->sourceModel(); previous)
+        disconnect(previous, nullptr, this, nullptr);
+    _accepted.clear();
+
+    //connected before the proxy itself, so that results are up to date when it filters changed rows
+    connect(sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, [this](const QModelIndex &parent, int first, int last)
+    {
+        for (int i = first; i <= last; ++i)
+            forget(this->sourceModel()->index(i, 0, parent));
+    });
+    connect(sourceModel, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex &parent, int first, int last)
+    {
+        for (int i = first; i <= last; ++i)
+        {
+            auto index = this->sourceModel()->index(i, 0, parent);
+            recheck(static_cast<route::MVCObject*>(index.internalPointer()));
+            updateAncestors(index);
+        }
+    });
+    connect(sourceModel, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight)
+    {
+        for (int i = topLeft.row(); i <= bottomRight.row(); ++i)
+        {
+            auto index = topLeft.siblingAtRow(i).siblingAtColumn(0);
+            _accepted.erase(index.internalPointer());
+            if(_registry)
+                markStale(_registry->slot(static_cast<const route::MVCObject*>(index.internalPointer())));
+            //a renamed row may have stopped matching, so ancestors shown for it are evaluated again
+            forgetAncestors(index);
+        }
+    });
+    connect(sourceModel, &QAbstractItemModel::modelAboutToBeReset, this, [this]() { _accepted.clear(); });
+    connect(sourceModel, &QAbstractItemModel::layoutAboutToBeChanged, this, [this]() { _accepted.clear(); });
+
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+}
+
+void TilesSorter::setIndices(vsg::ref_ptr<ObjectRegistry> registry, vsg::ref_ptr<NameIndex> names, vsg::ref_ptr<FacetIndex> facets)
+{
+    _registry = registry;
+    _names = names;
+    _facets = facets;
+    _matches.clear();
+    _touched.clear();
+    _pending = false;
+    ++*_serial;
+}
+
+void TilesSorter::setPattern(const QString &pattern)
+{
+    _pattern = pattern;
+    if(!_names)
+    {
+        _accepted.clear();
+        setFilterWildcard(pattern);
+        return;
+    }
+    refilter();
+}
+
+void TilesSorter::setFacets(const FacetIndex::Query &query)
+{
+    _query = query;
+    if(!_names)
+    {
+        _accepted.clear();
+        invalidateFilter();
+        return;
+    }
+    refilter();
+}
+
+void TilesSorter::refilter()
+{
+    auto serial = ++*_serial;
+    _touched.clear();
+    _pending = true;
+
+    //facet bits are cheap to select, so the worker gets a copy instead of the index
+    FacetIndex::Bits facets;
+    if(_facets && !_query.empty())
+        facets = _facets->select(_query);
+    _names->prepare();
+
+    auto work = [names = _names, pattern = _pattern, cs = filterCaseSensitivity(), facets = std::move(facets),
+                 slotCount = _registry->slotCount(), latest = _serial, serial]()
+    {
+        auto cancelled = [&latest, serial]() { return latest->load() != serial; };
+
+        std::vector<Match> result;
+        auto matched = names->match(pattern, cs, cancelled);
+        if(cancelled())
+            return result;
+
+        result.assign(slotCount, No);
+        for (auto slot : matched)
+        {
+            if(slot < slotCount && (facets.empty() || FacetIndex::test(facets, slot)))
+                result[slot] = Yes;
+        }
+        return result;
+    };
+
+    auto apply = [this, pattern = _pattern, serial](std::vector<Match> result)
+    {
+        //a newer query is running or the indices were replaced
+        if(_serial->load() != serial)
+            return;
+
+        _matches = std::move(result);
+        for (auto slot : _touched)
+            markStale(slot);
+        _touched.clear();
+        _pending = false;
+        _accepted.clear();
+
+        if(filterRegularExpression().pattern() != QRegularExpression::wildcardToRegularExpression(pattern, QRegularExpression::UnanchoredWildcardConversion))
+            setFilterWildcard(pattern);
+        else
+            invalidateFilter();
+    };
+
+    QtConcurrent::run(work).then(this, apply);
+}
+
+void TilesSorter::markStale(uint32_t slot)
+{
+    if(slot < _matches.size())
+        _matches[slot] = Unknown;
+    if(_pending && slot != ObjectRegistry::NULL_SLOT)
+        _touched.push_back(slot);
+}
+
 bool TilesSorter::filterAcceptsRow(int source_row, const QModelIndex & source_parent) const
 {
-    bool result = QSortFilterProxyModel::filterAcceptsRow(source_row,source_parent);
-    QModelIndex currentIndex = sourceModel()->index(source_row, 0, source_parent);
-    if (sourceModel()->hasChildren(currentIndex))
-        for (int i = 0; i < sourceModel()->rowCount(currentIndex) && !result; ++i)
-            result = result || filterAcceptsRow(i, currentIndex);
+    return accepted(sourceModel()->index(source_row, 0, source_parent));
+}
+
+bool TilesSorter::accepted(const QModelIndex &index) const
+{
+    if(auto it = _accepted.find(index.internalPointer()); it != _accepted.end())
+        return it->second;
+    return evaluate(index);
+}
+
+bool TilesSorter::evaluate(const QModelIndex &index) const
+{
+    //nothing to filter by, so the tree is not walked
+    if(_pattern.isEmpty() && _query.empty())
+        return true;
+
+    bool result = matches(index);
+    //every fetched child is visited, so the whole subtree is memoised in one pass
+    int count = sourceModel()->rowCount(index);
+    for (int i = 0; i < count; ++i)
+        result = accepted(sourceModel()->index(i, 0, index)) || result;
+    //matches in rows that are not fetched yet must keep their parents visible
+    if(!result)
+        result = matchesUnfetched(static_cast<route::MVCObject*>(index.internalPointer()), count);
+    _accepted[index.internalPointer()] = result;
     return result;
 }
 
+bool TilesSorter::matches(const QModelIndex &index) const
+{
+    if(!_registry)
+        return QSortFilterProxyModel::filterAcceptsRow(index.row(), index.parent());
+
+    auto slot = _registry->slot(static_cast<const route::MVCObject*>(index.internalPointer()));
+    if(slot < _matches.size() && _matches[slot] != Unknown)
+        return _matches[slot] == Yes;
+
+    //objects added or renamed after the query
+    return (!_facets || _facets->matches(_query, slot)) && QSortFilterProxyModel::filterAcceptsRow(index.row(), index.parent());
+}
+
+bool TilesSorter::matchesUnfetched(route::MVCObject *node, int first) const
+{
+    //such rows have no indexes yet, only the results of the last query are looked at,
+    //objects changed since then are checked once their rows are fetched
+    if(!_registry || !node)
+        return false;
+    for (int i = first; i < node->childrenCount(); ++i)
+    {
+        auto child = node->at(i);
+        auto slot = _registry->slot(child);
+        if((slot < _matches.size() && _matches[slot] == Yes) || matchesUnfetched(child, 0))
+            return true;
+    }
+    return false;
+}
+
+void TilesSorter::forget(const QModelIndex &index)
+{
+    //removed nodes may be destroyed and their addresses reused
+    if(_accepted.erase(index.internalPointer()) == 0)
+        return;
+    for (int i = 0, count = sourceModel()->rowCount(index); i < count; ++i)
+        forget(sourceModel()->index(i, 0, index));
+}
+
+void TilesSorter::recheck(route::MVCObject *node)
+{
+    //new objects may have taken slots of destroyed ones, rows that are not fetched yet included
+    if(!_registry || !node)
+        return;
+    markStale(_registry->slot(node));
+    for (int i = 0; i < node->childrenCount(); ++i)
+        recheck(node->at(i));
+}
+
+void TilesSorter::updateAncestors(const QModelIndex &index)
+{
+    if(!accepted(index))
+        return;
+
+    bool shown = false;
+    for (auto parent = index.parent(); parent.isValid(); parent = parent.parent())
+    {
+        auto it = _accepted.find(parent.internalPointer());
+        if(it == _accepted.end() || it->second)
+            break;
+        it->second = true;
+        shown = true;
+    }
+
+    //a hidden ancestor has got a matching descendant, the proxy would not look at it again on its own
+    if(shown)
+        QMetaObject::invokeMethod(this, [this]() { invalidateFilter(); }, Qt::QueuedConnection);
+}
+
+void TilesSorter::forgetAncestors(const QModelIndex &index)
+{
+    bool forgotten = false;
+    for (auto parent = index.parent(); parent.isValid(); parent = parent.parent())
+        forgotten = _accepted.erase(parent.internalPointer()) > 0 || forgotten;
+
+    if(forgotten)
+        QMetaObject::invokeMethod(this, [this]() { invalidateFilter(); }, Qt::QueuedConnection);
+}
+
 void TilesSorter::select(const QModelIndex &index)
 {
     emit viewSelectSignal(mapFromSource(index), QItemSelectionModel::Select);
@@ -24,6 +260,16 @@ void TilesSorter::deselect(const QModelIndex &index)
     emit viewSelectSignal(mapFromSource(index), QItemSelectionModel::Deselect);
 }
 
+void TilesSorter::selectBatch(const QItemSelection &selection)
+{
+    emit viewSelectionSignal(mapSelectionFromSource(selection), QItemSelectionModel::Select);
+}
+
+void TilesSorter::deselectBatch(const QItemSelection &selection)
+{
+    emit viewSelectionSignal(mapSelectionFromSource(selection), QItemSelectionModel::Deselect);
+}
+
 void TilesSorter::expand(const QModelIndex &index)
 {
     emit viewExpandSignal(mapFromSource(index));
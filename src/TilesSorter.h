@@ -3,6 +3,11 @@
 
 #include <QSortFilterProxyModel>
 #include <QItemSelectionModel>
+#include <unordered_map>
+#include <atomic>
+#include <memory>
+#include "NameIndex.h"
+#include "FacetIndex.h"
 
 class TilesSorter: public QSortFilterProxyModel
 {
@@ -10,9 +15,19 @@ class TilesSorter: public QSortFilterProxyModel
 public:
     TilesSorter(QObject *parent = nullptr);
 
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+
+    //names and facets are then matched through the indices instead of row by row
+    void setIndices(vsg::ref_ptr<ObjectRegistry> registry, vsg::ref_ptr<NameIndex> names, vsg::ref_ptr<FacetIndex> facets);
+
 public slots:
+    void setPattern(const QString &pattern);
+    void setFacets(const FacetIndex::Query &query);
+
     void select(const QModelIndex &index);
     void deselect(const QModelIndex &index);
+    void selectBatch(const QItemSelection &selection);
+    void deselectBatch(const QItemSelection &selection);
     void expand(const QModelIndex &index);
 
     void viewSelectSlot(const QItemSelection &selected, const QItemSelection &deselected);
@@ -24,9 +39,52 @@ signals:
     void doubleClicked(const QModelIndex &index);
 
     void viewSelectSignal(const QModelIndex &index, QItemSelectionModel::SelectionFlags command);
+    void viewSelectionSignal(const QItemSelection &selection, QItemSelectionModel::SelectionFlags command);
     void viewExpandSignal(const QModelIndex &index);
 
 protected:
     virtual bool filterAcceptsRow(int source_row, const QModelIndex & source_parent) const override;
+
+private:
+    //whether the row or any of its descendants matches, computed once per pattern
+    bool accepted(const QModelIndex &index) const;
+    bool evaluate(const QModelIndex &index) const;
+    bool matches(const QModelIndex &index) const;
+    bool matchesUnfetched(route::MVCObject *node, int first) const;
+
+    void forget(const QModelIndex &index);
+    void recheck(route::MVCObject *node);
+    //shows hidden ancestors of a matching row
+    void updateAncestors(const QModelIndex &index);
+    //drops the results of all ancestors, for rows that may have stopped matching
+    void forgetAncestors(const QModelIndex &index);
+
+    //matches are computed on a worker thread and applied when the latest query finishes
+    void refilter();
+    void markStale(uint32_t slot);
+
+    //keyed by internal pointers, which are the nodes in SceneModel
+    mutable std::unordered_map<const void*, bool> _accepted;
+
+    enum Match : char
+    {
+        Unknown,
+        No,
+        Yes
+    };
+
+    vsg::ref_ptr<ObjectRegistry> _registry;
+    vsg::ref_ptr<NameIndex> _names;
+    vsg::ref_ptr<FacetIndex> _facets;
+
+    QString _pattern;
+    FacetIndex::Query _query;
+    std::vector<Match> _matches;
+
+    //serial of the latest query, running queries stop once it changes
+    std::shared_ptr<std::atomic<uint64_t>> _serial;
+    //slots changed while a query is running, its result may be stale for them
+    std::vector<uint32_t> _touched;
+    bool _pending = false;
 };
 #endif // TILESSORTER_H
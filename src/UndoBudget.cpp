@@ -0,0 +1,286 @@
+#include "UndoBudget.h"
+#include <unordered_set>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+    //references to every object from inside the subtrees, an object referenced more often than that
+    //is shared with the rest of the scene, like loaded models or the common wire box
+    class ReferenceVisitor : public vsg::ConstVisitor
+    {
+    public:
+        std::unordered_map<const vsg::Object*, unsigned> references;
+
+        void apply(const vsg::Object &object) override
+        {
+            if(references[&object]++ == 0)
+                object.traverse(*this);
+        }
+        void apply(const vsg::Data &data) override
+        {
+            ++references[&data];
+        }
+    };
+
+    //bytes kept alive only by the subtrees, shared objects are collected instead of counted
+    class CostVisitor : public vsg::ConstVisitor
+    {
+    public:
+        explicit CostVisitor(const ReferenceVisitor &references) : _references(references.references) {}
+
+        size_t bytes = 0;
+        std::vector<vsg::ref_ptr<vsg::Object>> shared;
+
+        void apply(const vsg::Object &object) override
+        {
+            if(!_visited.insert(&object).second)
+                return;
+            if(isShared(object))
+            {
+                shared.emplace_back(const_cast<vsg::Object*>(&object));
+                return;
+            }
+            bytes += sizeof(vsg::Object);
+            object.traverse(*this);
+        }
+        void apply(const vsg::Data &data) override
+        {
+            if(!_visited.insert(&data).second)
+                return;
+            if(isShared(data))
+                shared.emplace_back(const_cast<vsg::Data*>(&data));
+            else
+                bytes += data.dataSize();
+        }
+
+        bool isShared(const vsg::Object &object) const
+        {
+            auto it = _references.find(&object);
+            return it == _references.end() || object.referenceCount() > it->second;
+        }
+
+    private:
+        const std::unordered_map<const vsg::Object*, unsigned> &_references;
+        std::unordered_set<const vsg::Object*> _visited;
+    };
+
+    struct Usage
+    {
+        size_t bytes = 0;
+        std::vector<vsg::ref_ptr<vsg::Object>> shared;
+        //the nodes are held once by the command and once per visit, anything more means they are used elsewhere
+        bool rootsShared = false;
+    };
+
+    Usage usage(const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes)
+    {
+        ReferenceVisitor references;
+        for (const auto &node : nodes)
+            node->accept(references);
+
+        CostVisitor visitor(references);
+        Usage result;
+        for (const auto &node : nodes)
+        {
+            result.rootsShared = result.rootsShared || visitor.isShared(*node);
+            node->accept(visitor);
+        }
+        result.bytes = visitor.bytes;
+        result.shared = std::move(visitor.shared);
+        return result;
+    }
+}
+
+PackedNodes::PackedNodes(SceneModel *model, const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes, bool attached)
+    : _model(model)
+    , _nodes(nodes)
+    , _attached(attached)
+{
+}
+
+const std::vector<vsg::ref_ptr<route::MVCObject>> &PackedNodes::nodes()
+{
+    resolve();
+    if(_nodes.empty() && !_packed.isEmpty())
+    {
+        auto data = qUncompress(_packed);
+        _nodes = _standalone ? _model->readNodes(data, "vsgb") : _model->unpackNodes(data, _shared);
+        _model->compile(_nodes);
+        _packed.clear();
+        _shared.clear();
+        _standalone = false;
+        _costKnown = false;
+    }
+    return _nodes;
+}
+
+void PackedNodes::resolve()
+{
+    if(_ids.empty())
+        return;
+    for (auto id : _ids)
+        if(auto node = _registry->object(id); node)
+            _nodes.emplace_back(node);
+    _ids.clear();
+}
+
+void PackedNodes::attach()
+{
+    resolve();
+    _attached = true;
+    _costKnown = false;
+    _unpackable = false;
+}
+
+void PackedNodes::detach()
+{
+    resolve();
+    _attached = false;
+    _costKnown = false;
+    _unpackable = false;
+}
+
+size_t PackedNodes::memoryCost() const
+{
+    if(_attached)
+        return 0;
+    if(!_packed.isEmpty())
+        return static_cast<size_t>(_packed.size());
+    if(!_costKnown)
+    {
+        _cost = usage(_nodes).bytes;
+        _costKnown = true;
+    }
+    return _cost;
+}
+
+bool PackedNodes::pack()
+{
+    if(_attached || _nodes.empty() || _unpackable)
+        return false;
+
+    //nodes still referenced elsewhere, e.g. by other commands, would come back as copies,
+    //that does not change until they are attached again, so the budget does not look at them twice
+    auto used = usage(_nodes);
+    if(used.rootsShared)
+    {
+        _unpackable = true;
+        return false;
+    }
+
+    //models and the wire box stay in memory for other objects anyway, the payload refers to them
+    _shared = std::move(used.shared);
+    _packed = qCompress(_model->packNodes(_nodes, _shared));
+    _nodes.clear();
+    return true;
+}
+
+void PackedNodes::write(QDataStream &stream, const ObjectRegistry &registry) const
+{
+    stream << _attached;
+    if(_attached)
+    {
+        stream << static_cast<quint32>(_nodes.size() + _ids.size());
+        for (const auto &node : _nodes)
+            stream << static_cast<quint64>(registry.id(node));
+        for (auto id : _ids)
+            stream << static_cast<quint64>(id);
+    }
+    else if(_packed.isEmpty())
+        stream << qCompress(_model->writeNodes(_nodes, "vsgb"));
+    else if(_standalone)
+        stream << _packed;
+    else
+        //shared objects can only be referred to within the session, the history gets whole subtrees
+        stream << qCompress(_model->writeNodes(_model->unpackNodes(qUncompress(_packed), _shared), "vsgb"));
+}
+
+PackedNodes PackedNodes::read(QDataStream &stream, SceneModel *model, const ObjectRegistry &registry)
+{
+    bool attached = false;
+    stream >> attached;
+
+    PackedNodes result(model, {}, attached);
+    if(attached)
+    {
+        quint32 count = 0;
+        stream >> count;
+        result._registry = &registry;
+        for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+        {
+            quint64 id = 0;
+            stream >> id;
+            result._ids.push_back(id);
+        }
+    }
+    else
+    {
+        stream >> result._packed;
+        result._standalone = true;
+    }
+    return result;
+}
+
+UndoBudget::UndoBudget(QUndoStack *stack, size_t budget, QObject *parent) : QObject(parent)
+    , _stack(stack)
+    , _budget(budget)
+{
+    connect(stack, &QUndoStack::indexChanged, this, &UndoBudget::enforce);
+}
+
+void UndoBudget::setBudget(size_t bytes)
+{
+    _budget = bytes;
+    enforce();
+}
+
+void UndoBudget::enforce()
+{
+    struct Entry
+    {
+        int distance;
+        CompactCommand *command;
+        size_t cost;
+    };
+    std::vector<Entry> entries;
+    size_t used = 0;
+
+    std::function<void(const QUndoCommand*, int)> collect = [&](const QUndoCommand *command, int distance)
+    {
+        //commands belong to the stack, compacting them does not change what they do
+        if(auto compactable = dynamic_cast<CompactCommand*>(const_cast<QUndoCommand*>(command)); compactable)
+        {
+            auto cost = compactable->memoryCost();
+            used += cost;
+            if(cost != 0)
+                entries.push_back({distance, compactable, cost});
+        }
+        for (int i = 0; i < command->childCount(); ++i)
+            collect(command->child(i), distance);
+    };
+
+    auto index = _stack->index();
+    for (int i = 0; i < _stack->count(); ++i)
+        collect(_stack->command(i), i < index ? index - 1 - i : i - index);
+
+    if(_budget != 0 && used > _budget)
+    {
+        //steps farthest from the current state are the least likely to be undone or redone
+        std::sort(entries.begin(), entries.end(), [](const Entry &lhs, const Entry &rhs){ return lhs.distance > rhs.distance; });
+        for (const auto &entry : entries)
+        {
+            if(used <= _budget)
+                break;
+            if(entry.command->compact())
+                used = used - entry.cost + entry.command->memoryCost();
+        }
+    }
+
+    if(used != _used)
+    {
+        _used = used;
+        emit usageChanged(used);
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef UNDOBUDGET_H
+#define UNDOBUDGET_H
+
+#include <QUndoStack>
+#include <QDataStream>
+#include "SceneObjectsModel.h"
+
+//Undo steps that keep detached subtrees alive and can shrink them.
+class CompactCommand
+{
+public:
+    virtual ~CompactCommand() = default;
+
+    //bytes kept alive only by the command
+    virtual size_t memoryCost() const = 0;
+    //returns false when there is nothing to compact or it is not safe now
+    virtual bool compact() = 0;
+};
+
+//Subtrees removed from the scene and held by an undo command.
+//Once compacted they are kept compressed, with references to objects shared with the scene, and read back when the command needs them again.
+class PackedNodes
+{
+public:
+    PackedNodes(SceneModel *model, const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes, bool attached);
+
+    const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes();
+
+    //detaching takes hold of the nodes, so call it before they are removed from the scene
+    void attach();
+    void detach();
+
+    size_t memoryCost() const;
+    bool pack();
+
+    //attached nodes are written as IDs, detached ones as compressed vsgb
+    void write(QDataStream &stream, const ObjectRegistry &registry) const;
+    //attached nodes are looked up when they are first needed, they may only come back through another step
+    static PackedNodes read(QDataStream &stream, SceneModel *model, const ObjectRegistry &registry);
+
+private:
+    void resolve();
+
+    SceneModel *_model;
+    std::vector<vsg::ref_ptr<route::MVCObject>> _nodes;
+    //IDs of restored attached nodes that have not been looked up yet
+    const ObjectRegistry *_registry = nullptr;
+    std::vector<ObjectRegistry::ID> _ids;
+    QByteArray _packed;
+    //objects of the packed nodes that are used elsewhere too, the payload refers to them
+    std::vector<vsg::ref_ptr<vsg::Object>> _shared;
+    //restored payloads are whole vsgb without references
+    bool _standalone = false;
+    bool _attached;
+    //nodes used outside of the command can not be packed, cached until they are attached or detached again
+    bool _unpackable = false;
+
+    mutable size_t _cost = 0;
+    mutable bool _costKnown = false;
+};
+
+//Compacts the oldest steps of the history once it outgrows the budget.
+class UndoBudget : public QObject
+{
+    Q_OBJECT
+public:
+    UndoBudget(QUndoStack *stack, size_t budget, QObject *parent = nullptr);
+
+    void setBudget(size_t bytes);
+    size_t budget() const { return _budget; }
+    size_t used() const { return _used; }
+
+public slots:
+    void enforce();
+
+signals:
+    void usageChanged(size_t bytes);
+
+private:
+    QUndoStack *_stack;
+    size_t _budget;
+    size_t _used = 0;
+};
+
+#endif // UNDOBUDGET_H
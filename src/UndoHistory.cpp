@@ -0,0 +1,210 @@
+#include "UndoHistory.h"
+#include "undo-redo.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <memory>
+
+namespace
+{
+    constexpr quint32 HISTORY_MAGIC = 0x52554e44;
+    constexpr quint32 HISTORY_VERSION = 1;
+
+    //the route on disk already is in the saved state, so pushing a restored step must not apply it again,
+    //steps that had been undone also skip the undo that brings the stack back to the saved index
+    class RestoredCommand : public QUndoCommand
+    {
+    public:
+        explicit RestoredCommand(bool done)
+            : _skipRedo(true)
+            , _skipUndo(!done)
+        {
+        }
+        void redo() override
+        {
+            if(_skipRedo)
+                _skipRedo = false;
+            else
+                QUndoCommand::redo();
+        }
+        void undo() override
+        {
+            if(_skipUndo)
+                _skipUndo = false;
+            else
+                QUndoCommand::undo();
+        }
+    private:
+        bool _skipRedo;
+        bool _skipUndo;
+    };
+}
+
+QByteArray UndoHistory::revision(const std::vector<std::string> &paths)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const auto &path : paths)
+    {
+        QFileInfo info(QString::fromStdString(path));
+        hash.addData(info.absoluteFilePath().toUtf8());
+        hash.addData(QByteArray::number(info.size()));
+        hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    }
+    return hash.result();
+}
+
+bool UndoHistory::save(const QString &path, const QByteArray &revision, const QUndoStack *stack, const ObjectRegistry &registry)
+{
+    //only the steps around the current index that can all be written are kept
+    auto index = stack->index();
+    auto first = index;
+    while (first > 0 && persistent(stack->command(first - 1)))
+        --first;
+    auto last = index;
+    while (last < stack->count() && persistent(stack->command(last)))
+        ++last;
+
+    QFile file(path);
+    if(first == last)
+        return !file.exists() || file.remove();
+
+    QByteArray data;
+    {
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_6_0);
+        stream << revision << static_cast<qint32>(index - first) << static_cast<qint32>(last - first);
+        for (auto i = first; i < last; ++i)
+            write(stream, stack->command(i), registry);
+    }
+
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << HISTORY_MAGIC << HISTORY_VERSION << qCompress(data);
+    return out.status() == QDataStream::Ok;
+}
+
+bool UndoHistory::restore(const QString &path, const QByteArray &revision, QUndoStack *stack, SceneModel *model, const ObjectRegistry &registry)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray compressed;
+    in >> magic >> version >> compressed;
+    if(in.status() != QDataStream::Ok || magic != HISTORY_MAGIC || version != HISTORY_VERSION)
+        return false;
+
+    auto data = qUncompress(compressed);
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_6_0);
+    QByteArray saved;
+    qint32 index = 0;
+    qint32 count = 0;
+    stream >> saved >> index >> count;
+    //tiles have been changed outside of this history
+    if(stream.status() != QDataStream::Ok || saved != revision)
+        return false;
+
+    //nothing is pushed until every step has been read
+    std::vector<std::unique_ptr<QUndoCommand>> commands;
+    for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+    {
+        auto restored = std::make_unique<RestoredCommand>(i < index);
+        if(auto command = read(stream, model, registry, restored.get()); command)
+            restored->setText(command->text());
+        commands.push_back(std::move(restored));
+    }
+    if(stream.status() != QDataStream::Ok)
+        return false;
+
+    stack->clear();
+    for (auto &command : commands)
+        stack->push(command.release());
+    stack->setIndex(index);
+    stack->setClean();
+    return true;
+}
+
+bool UndoHistory::persistent(const QUndoCommand *command)
+{
+    if(dynamic_cast<const PersistentCommand*>(command))
+        return true;
+    //macros are written when all of their steps can be
+    if(command->childCount() == 0)
+        return false;
+    for (int i = 0; i < command->childCount(); ++i)
+        if(!persistent(command->child(i)))
+            return false;
+    return true;
+}
+
+void UndoHistory::write(QDataStream &stream, const QUndoCommand *command, const ObjectRegistry &registry)
+{
+    if(auto persistent = dynamic_cast<const PersistentCommand*>(command); persistent)
+    {
+        stream << static_cast<quint8>(persistent->type()) << command->text();
+        persistent->write(stream, registry);
+        return;
+    }
+
+    stream << static_cast<quint8>(PersistentCommand::Type::Macro) << command->text() << static_cast<qint32>(command->childCount());
+    for (int i = 0; i < command->childCount(); ++i)
+        write(stream, command->child(i), registry);
+}
+
+QUndoCommand *UndoHistory::read(QDataStream &stream, SceneModel *model, const ObjectRegistry &registry, QUndoCommand *parent)
+{
+    quint8 type = 0;
+    QString text;
+    stream >> type >> text;
+
+    QUndoCommand *command = nullptr;
+    switch (static_cast<PersistentCommand::Type>(type))
+    {
+    case PersistentCommand::Type::Macro:
+    {
+        command = new QUndoCommand(parent);
+        qint32 count = 0;
+        stream >> count;
+        for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+            read(stream, model, registry, command);
+        break;
+    }
+    case PersistentCommand::Type::AddObject:
+        command = new AddSceneObject(model, registry, stream, parent);
+        break;
+    case PersistentCommand::Type::AddObjects:
+        command = new AddSceneObjects(model, registry, stream, parent);
+        break;
+    case PersistentCommand::Type::RemoveObject:
+        command = new RemoveNode(model, registry, stream, parent);
+        break;
+    case PersistentCommand::Type::RemoveObjects:
+        command = new RemoveNodes(model, registry, stream, parent);
+        break;
+    case PersistentCommand::Type::TransformObjects:
+        command = new TransformObjects(model, stream, parent);
+        break;
+    case PersistentCommand::Type::MoveObject:
+        command = new MoveObject(registry, stream, parent);
+        break;
+    case PersistentCommand::Type::RotateObject:
+        command = new RotateObject(registry, stream, parent);
+        break;
+    case PersistentCommand::Type::RenameObject:
+        command = new RenameObject(model, registry, stream, parent);
+        break;
+    default:
+        stream.setStatus(QDataStream::ReadCorruptData);
+        return nullptr;
+    }
+    command->setText(text);
+    return command;
+}
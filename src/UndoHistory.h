@@ -0,0 +1,123 @@
+#ifndef UNDOHISTORY_H
+#define UNDOHISTORY_H
+
+#include <QUndoStack>
+#include <QDataStream>
+#include "ObjectRegistry.h"
+
+class SceneModel;
+
+//Object of an undo step, either held directly or, for restored steps, looked up by ID when the step runs.
+//A restored step may refer to an object that is not in the route on disk, because a later step removed it
+//and only undoing that step brings it back.
+class ObjectRef
+{
+public:
+    ObjectRef(route::MVCObject *object = nullptr)
+        : _object(object)
+    {
+    }
+    ObjectRef(const ObjectRegistry *registry, ObjectRegistry::ID id)
+        : _registry(registry)
+        , _id(id)
+    {
+    }
+
+    route::MVCObject *get() const
+    {
+        if(!_object && _registry && _id != ObjectRegistry::NULL_ID)
+            _object = _registry->object(_id);
+        return _object.get();
+    }
+    route::MVCObject *operator->() const { return get(); }
+
+    ObjectRegistry::ID id(const ObjectRegistry &registry) const
+    {
+        return _object ? registry.id(_object) : _id;
+    }
+
+private:
+    mutable vsg::ref_ptr<route::MVCObject> _object;
+    const ObjectRegistry *_registry = nullptr;
+    ObjectRegistry::ID _id = ObjectRegistry::NULL_ID;
+};
+
+//Undo steps that can be written to the history file and rebuilt from it.
+//Objects are written as registry IDs, which stay the same across sessions.
+class PersistentCommand
+{
+public:
+    enum class Type : quint8
+    {
+        Macro,
+        AddObject,
+        AddObjects,
+        RemoveObject,
+        RemoveObjects,
+        TransformObjects,
+        MoveObject,
+        RotateObject,
+        RenameObject
+    };
+
+    virtual ~PersistentCommand() = default;
+
+    virtual Type type() const = 0;
+    virtual void write(QDataStream &stream, const ObjectRegistry &registry) const = 0;
+
+protected:
+    static void writeId(QDataStream &stream, const ObjectRegistry &registry, const ObjectRef &object)
+    {
+        stream << static_cast<quint64>(object.id(registry));
+    }
+    static ObjectRegistry::ID readId(QDataStream &stream)
+    {
+        quint64 id = ObjectRegistry::NULL_ID;
+        stream >> id;
+        return id;
+    }
+    //resolved when the step runs, not when it is read
+    static ObjectRef readObject(QDataStream &stream, const ObjectRegistry &registry)
+    {
+        return ObjectRef(&registry, readId(stream));
+    }
+};
+
+//History of the undo stack saved next to the route.
+//It is restored only when the tiles on disk are the ones it has been saved with.
+class UndoHistory
+{
+public:
+    //fingerprint of the route and tile files as they are on disk
+    static QByteArray revision(const std::vector<std::string> &paths);
+
+    static bool save(const QString &path, const QByteArray &revision, const QUndoStack *stack, const ObjectRegistry &registry);
+    static bool restore(const QString &path, const QByteArray &revision, QUndoStack *stack, SceneModel *model, const ObjectRegistry &registry);
+
+private:
+    static bool persistent(const QUndoCommand *command);
+    static void write(QDataStream &stream, const QUndoCommand *command, const ObjectRegistry &registry);
+    static QUndoCommand *read(QDataStream &stream, SceneModel *model, const ObjectRegistry &registry, QUndoCommand *parent);
+};
+
+inline QDataStream &operator<<(QDataStream &stream, const vsg::dvec3 &v)
+{
+    return stream << v.x << v.y << v.z;
+}
+
+inline QDataStream &operator>>(QDataStream &stream, vsg::dvec3 &v)
+{
+    return stream >> v.x >> v.y >> v.z;
+}
+
+inline QDataStream &operator<<(QDataStream &stream, const vsg::dquat &q)
+{
+    return stream << q.x << q.y << q.z << q.w;
+}
+
+inline QDataStream &operator>>(QDataStream &stream, vsg::dquat &q)
+{
+    return stream >> q.x >> q.y >> q.z >> q.w;
+}
+
+#endif // UNDOHISTORY_H
@@ -0,0 +1,153 @@
+#include "UndoProfiler.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+namespace
+{
+    const char *phaseName(UndoProfiler::Phase phase)
+    {
+        switch (phase)
+        {
+        case UndoProfiler::Redo:
+            return "redo";
+        case UndoProfiler::Undo:
+            return "undo";
+        default:
+            return "handler";
+        }
+    }
+}
+
+quint64 UndoProfiler::Stats::percentile(double fraction) const
+{
+    auto target = static_cast<quint64>(std::ceil(fraction * static_cast<double>(count)));
+    quint64 seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i)
+    {
+        seen += histogram[i];
+        if(seen >= target && seen != 0)
+            return i + 1 == BUCKETS ? max : (quint64(1) << (i + 1));
+    }
+    return max;
+}
+
+UndoProfiler::Scope::Scope(const char *name, Phase phase)
+    : _name(name)
+    , _phase(phase)
+    , _start(std::chrono::steady_clock::now())
+{
+}
+
+UndoProfiler::Scope::Scope(const std::type_info &type, Phase phase)
+    : _name(UndoProfiler::instance().typeName(type))
+    , _phase(phase)
+    , _start(std::chrono::steady_clock::now())
+{
+}
+
+UndoProfiler::Scope::~Scope()
+{
+    UndoProfiler::instance().record(_name, _phase, _start, std::chrono::steady_clock::now());
+}
+
+UndoProfiler::UndoProfiler()
+    : _epoch(std::chrono::steady_clock::now())
+{
+}
+
+UndoProfiler &UndoProfiler::instance()
+{
+    static UndoProfiler profiler;
+    return profiler;
+}
+
+void UndoProfiler::record(const char *name, Phase phase, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    auto us = static_cast<quint64>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+
+    auto &stats = _stats[{name, phase}];
+    if(stats.count == 0)
+    {
+        stats.name = QString::fromLatin1(name);
+        stats.phase = phase;
+    }
+    ++stats.count;
+    stats.total += us;
+    stats.max = std::max(stats.max, us);
+
+    size_t bucket = 0;
+    while (bucket + 1 < BUCKETS && (us >> (bucket + 1)) != 0)
+        ++bucket;
+    ++stats.histogram[bucket];
+
+    if(_trace.isOpen())
+    {
+        QJsonObject event;
+        event["name"] = stats.name;
+        event["cat"] = phaseName(phase);
+        event["ph"] = "X";
+        event["ts"] = static_cast<qint64>(std::chrono::duration_cast<std::chrono::microseconds>(start - _epoch).count());
+        event["dur"] = static_cast<qint64>(us);
+        event["pid"] = 1;
+        event["tid"] = 1;
+        //the trace viewer accepts an array without the closing bracket
+        _trace.write(QJsonDocument(event).toJson(QJsonDocument::Compact) + ",\n");
+    }
+}
+
+const char *UndoProfiler::typeName(const std::type_info &type)
+{
+    auto it = _typeNames.find(type);
+    if(it != _typeNames.end())
+        return it->second.c_str();
+
+    std::string name = type.name();
+#if defined(__GNUG__)
+    int status = 0;
+    if(auto demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status); status == 0)
+    {
+        name = demangled;
+        std::free(demangled);
+    }
+#endif
+    //MSVC names start with the kind of the type
+    if(name.rfind("class ", 0) == 0)
+        name.erase(0, 6);
+    //lambdas of ExecuteLambda would otherwise give every call site a histogram of its own
+    name = name.substr(0, name.find('<'));
+
+    return _typeNames.emplace(type, name).first->second.c_str();
+}
+
+std::vector<UndoProfiler::Stats> UndoProfiler::stats() const
+{
+    std::vector<Stats> result;
+    result.reserve(_stats.size());
+    for (const auto &[key, stats] : _stats)
+        result.push_back(stats);
+    return result;
+}
+
+void UndoProfiler::reset()
+{
+    _stats.clear();
+}
+
+bool UndoProfiler::setTraceFile(const QString &path)
+{
+    _trace.close();
+    if(path.isEmpty())
+        return true;
+
+    _trace.setFileName(path);
+    if(!_trace.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    _trace.write("[\n");
+    return true;
+}
@@ -0,0 +1,103 @@
+#ifndef UNDOPROFILER_H
+#define UNDOPROFILER_H
+
+#include <QString>
+#include <QFile>
+#include <QUndoCommand>
+#include <array>
+#include <chrono>
+#include <map>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+//Latency of undo steps and of the handlers that refresh the editors after them.
+//Durations go to per-name histograms and, when a trace file is set, to a Chrome trace.
+class UndoProfiler
+{
+public:
+    enum Phase
+    {
+        Redo,
+        Undo,
+        Handler
+    };
+
+    //bucket i counts durations in [2^i, 2^(i+1)) microseconds, the last one everything above
+    static constexpr size_t BUCKETS = 24;
+
+    struct Stats
+    {
+        QString name;
+        Phase phase = Redo;
+        quint64 count = 0;
+        quint64 total = 0;
+        quint64 max = 0;
+        std::array<quint64, BUCKETS> histogram{};
+
+        //upper bound of the bucket holding the given fraction of samples, in microseconds
+        quint64 percentile(double fraction) const;
+    };
+
+    //times the enclosing block
+    class Scope
+    {
+    public:
+        Scope(const char *name, Phase phase);
+        //named after the class, without template arguments
+        Scope(const std::type_info &type, Phase phase);
+        ~Scope();
+    private:
+        const char *_name;
+        Phase _phase;
+        std::chrono::steady_clock::time_point _start;
+    };
+
+    static UndoProfiler &instance();
+
+    void record(const char *name, Phase phase, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+    std::vector<Stats> stats() const;
+    void reset();
+
+    //an empty path stops tracing
+    bool setTraceFile(const QString &path);
+    QString traceFile() const { return _trace.isOpen() ? _trace.fileName() : QString(); }
+
+private:
+    UndoProfiler();
+
+    const char *typeName(const std::type_info &type);
+
+    std::map<std::pair<std::string, Phase>, Stats> _stats;
+    std::unordered_map<std::type_index, std::string> _typeNames;
+
+    QFile _trace;
+    std::chrono::steady_clock::time_point _epoch;
+};
+
+//Undo step that is timed once per undo and redo, under the name of its class.
+//Steps implement undoStep() and redoStep(), so a step that calls into the one of its base class is not recorded twice.
+class TimedCommand : public QUndoCommand
+{
+public:
+    using QUndoCommand::QUndoCommand;
+
+    void undo() final
+    {
+        UndoProfiler::Scope scope(typeid(*this), UndoProfiler::Undo);
+        undoStep();
+    }
+    void redo() final
+    {
+        UndoProfiler::Scope scope(typeid(*this), UndoProfiler::Redo);
+        redoStep();
+    }
+
+protected:
+    virtual void undoStep() = 0;
+    virtual void redoStep() = 0;
+};
+
+#endif // UNDOPROFILER_H
@@ -11,3 +11,8 @@ void Tool::setCamera(vsg::ref_ptr<vsg::Camera> camera)
 {
     _camera = camera;
 }
+
+vsg::LineSegmentIntersector::Intersections Tool::intersect(const vsg::PointerEvent &event, uint32_t layers)
+{
+    return _database->picker->intersect(event, *_camera, layers);
+}
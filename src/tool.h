@@ -76,6 +76,8 @@ signals:
     void sendStatusText(const QString &message, int timeout);
 
 protected:
+    vsg::LineSegmentIntersector::Intersections intersect(const vsg::PointerEvent &event, uint32_t layers = Picker::Scene);
+
     DatabaseManager *_database;
     vsg::ref_ptr<vsg::Camera> _camera;
 };
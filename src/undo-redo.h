@@ -2,21 +2,27 @@
 #define UNDO_H
 
 #include "SceneObjectsModel.h"
+#include "UndoBudget.h"
+#include "UndoHistory.h"
+#include "UndoProfiler.h"
+#include "GroupTransform.h"
 #include "trajectory.h"
 #include "signals.h"
 #include <unordered_set>
+#include <unordered_map>
+#include <map>
 
-class AddSceneObject : public QUndoCommand
+class AddSceneObject : public TimedCommand, public PublishedCommand, public CompactCommand, public PersistentCommand
 {
 public:
     AddSceneObject(SceneModel *model,
             const QModelIndex &group,
             vsg::ref_ptr<route::MVCObject> node,
             QUndoCommand *parent = nullptr)
-        : QUndoCommand(parent)
+        : TimedCommand(parent)
         , _model(model)
-        , _group(group)
-        , _node(node)
+        , _group(static_cast<route::MVCObject*>(group.internalPointer()))
+        , _node(model, {node}, false)
     {
         auto name = node->getName();
         if(name.isEmpty())
@@ -24,43 +30,189 @@ public:
         setText(QObject::tr("Новый объект %1").arg(name));
     }
     AddSceneObject(SceneModel *model,
-            route::SceneGroup *group,
+            route::MVCObject *group,
             vsg::ref_ptr<route::MVCObject> node,
             QUndoCommand *parent = nullptr)
-        : AddSceneObject(model, model->index(group), node, parent)
+        : AddSceneObject(model, model->reveal(group), node, parent)
     {
     }
-    void undo() override
+    AddSceneObject(SceneModel *model, const ObjectRegistry &registry, QDataStream &stream, QUndoCommand *parent = nullptr)
+        : TimedCommand(parent)
+        , _model(model)
+        , _group(readObject(stream, registry))
+        , _node(PackedNodes::read(stream, model, registry))
     {
-        _model->removeNode(_model->index(_row, 0, _group));
+        stream >> _row;
     }
-    void redo() override
+    void undoStep() override
+    {
+        _node.detach();
+        _model->removeNode(_model->index(_row, 0, group()));
+    }
+    void redoStep() override
+    {
+        _row = _model->addNode(group(), _node.nodes().front());
+        _node.attach();
+    }
+    size_t memoryCost() const override
+    {
+        return _node.memoryCost();
+    }
+    bool compact() override
     {
-        _row = _model->addNode(_group, _node);
+        return _node.pack();
+    }
+    Type type() const override
+    {
+        return Type::AddObject;
+    }
+    void write(QDataStream &stream, const ObjectRegistry &registry) const override
+    {
+        writeId(stream, registry, _group);
+        _node.write(stream, registry);
+        stream << _row;
     }
 private:
+    QModelIndex group() const
+    {
+        return _group.get() ? _model->reveal(_group.get()) : QModelIndex();
+    }
+
     SceneModel *_model;
     int _row;
-    const QModelIndex _group;
-    vsg::ref_ptr<route::MVCObject> _node;
+    ObjectRef _group;
+    PackedNodes _node;
+
+};
+
+//Adds objects to any number of groups as one step, inserting into each group at once.
+class AddSceneObjects : public TimedCommand, public PublishedCommand, public CompactCommand, public PersistentCommand
+{
+public:
+    using Placement = std::pair<route::MVCObject*, vsg::ref_ptr<route::MVCObject>>;
+
+    AddSceneObjects(SceneModel *model,
+            const std::vector<Placement> &placements,
+            QUndoCommand *parent = nullptr)
+        : TimedCommand(parent)
+        , _model(model)
+    {
+        //groups keep the order in which they first appear
+        std::unordered_map<route::MVCObject*, size_t> positions;
+        std::vector<std::vector<vsg::ref_ptr<route::MVCObject>>> nodes;
+        std::vector<route::MVCObject*> groups;
+        for (const auto &[group, node] : placements)
+        {
+            auto [it, inserted] = positions.emplace(group, nodes.size());
+            if(inserted)
+            {
+                nodes.emplace_back();
+                groups.push_back(group);
+            }
+            nodes[it->second].push_back(node);
+        }
+        for (size_t i = 0; i < groups.size(); ++i)
+            _groups.push_back({ObjectRef(groups[i]), PackedNodes(model, nodes[i], false)});
+
+        setText(QObject::tr("Новые объекты (%1)").arg(placements.size()));
+    }
+    AddSceneObjects(SceneModel *model,
+            route::MVCObject *group,
+            const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes,
+            QUndoCommand *parent = nullptr)
+        : AddSceneObjects(model, placements(group, nodes), parent)
+    {
+    }
+    AddSceneObjects(SceneModel *model, const ObjectRegistry &registry, QDataStream &stream, QUndoCommand *parent = nullptr)
+        : TimedCommand(parent)
+        , _model(model)
+    {
+        quint32 count = 0;
+        stream >> count;
+        for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+        {
+            auto group = readObject(stream, registry);
+            _groups.push_back({group, PackedNodes::read(stream, model, registry)});
+        }
+    }
+    void undoStep() override
+    {
+        for (auto it = _groups.rbegin(); it != _groups.rend(); ++it)
+        {
+            _model->removeNodes(_model->reveal(it->group.get()), it->nodes.nodes());
+            it->nodes.detach();
+        }
+    }
+    void redoStep() override
+    {
+        for (auto &group : _groups)
+        {
+            _model->addNodes(_model->reveal(group.group.get()), group.nodes.nodes());
+            group.nodes.attach();
+        }
+    }
+    size_t memoryCost() const override
+    {
+        size_t cost = 0;
+        for (const auto &group : _groups)
+            cost += group.nodes.memoryCost();
+        return cost;
+    }
+    bool compact() override
+    {
+        bool compacted = false;
+        for (auto &group : _groups)
+            compacted = group.nodes.pack() || compacted;
+        return compacted;
+    }
+    Type type() const override
+    {
+        return Type::AddObjects;
+    }
+    void write(QDataStream &stream, const ObjectRegistry &registry) const override
+    {
+        stream << static_cast<quint32>(_groups.size());
+        for (const auto &group : _groups)
+        {
+            writeId(stream, registry, group.group);
+            group.nodes.write(stream, registry);
+        }
+    }
+private:
+    static std::vector<Placement> placements(route::MVCObject *group, const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes)
+    {
+        std::vector<Placement> result;
+        result.reserve(nodes.size());
+        for (const auto &node : nodes)
+            result.emplace_back(group, node);
+        return result;
+    }
+
+    struct Group
+    {
+        ObjectRef group;
+        PackedNodes nodes;
+    };
 
+    SceneModel *_model;
+    std::vector<Group> _groups;
 };
 
-class AddSignal : public QUndoCommand
+class AddSignal : public TimedCommand
 {
 public:
     AddSignal(route::Connector *rc,
               vsg::ref_ptr<signalling::Signal> sig,
               QUndoCommand *parent = nullptr)
-        : QUndoCommand(parent)
+        : TimedCommand(parent)
         , _rc(rc)
         , _sig(sig) {}
 
-    void undo() override
+    void undoStep() override
     {
         _rc->setSignal({});
     }
-    void redo() override
+    void redoStep() override
     {
         _rc->setSignal(_sig);
     }
@@ -78,70 +230,269 @@ public:
         setText(QObject::tr("Удален сигнал, направление назад"));
     }
 
-    void undo() override
+    void undoStep() override
     {
-        AddSignal::redo();
+        AddSignal::redoStep();
     }
-    void redo() override
+    void redoStep() override
     {
-        AddSignal::undo();
+        AddSignal::undoStep();
     }
 };
 
-class RemoveNode : public QUndoCommand
+class RemoveNode : public TimedCommand, public PublishedCommand, public CompactCommand, public PersistentCommand
 {
 public:
-    RemoveNode(SceneModel *model, const QModelIndex &index, QUndoCommand *parent = nullptr) : QUndoCommand(parent)
+    RemoveNode(SceneModel *model, const QModelIndex &index, QUndoCommand *parent = nullptr) : TimedCommand(parent)
         , _model(model)
-        , _node(static_cast<route::MVCObject*>(index.internalPointer()))
-        , _group(index.parent())
+        , _node(model, {vsg::ref_ptr<route::MVCObject>(static_cast<route::MVCObject*>(index.internalPointer()))}, true)
+        , _group(static_cast<route::MVCObject*>(index.parent().internalPointer()))
         , _row(index.row())
     {
+        auto node = static_cast<route::MVCObject*>(index.internalPointer());
         std::string name;
-        _node->getValue(app::NAME, name);
+        node->getValue(app::NAME, name);
         if(name.empty())
-            name = _node->className();
+            name = node->className();
         setText(QObject::tr("Удален объект %1").arg(name.c_str()));
-        if(auto scobj = _node.cast<route::SceneObject>(); scobj)
+        if(auto scobj = node->cast<route::SceneObject>(); scobj)
             scobj->setSelection(false);
     }
-    void undo() override
+    RemoveNode(SceneModel *model, const ObjectRegistry &registry, QDataStream &stream, QUndoCommand *parent = nullptr)
+        : TimedCommand(parent)
+        , _model(model)
+        , _node(PackedNodes::read(stream, model, registry))
+        , _group(readObject(stream, registry))
     {
-        _row = _model->addNode(_group, _node);
+        stream >> _row;
     }
-    void redo() override
+    void undoStep() override
+    {
+        _row = _model->addNode(group(), _node.nodes().front());
+        _node.attach();
+    }
+    void redoStep() override
     {
-        _model->removeNode(_model->index(_row, 0, _group));
+        _node.detach();
+        _model->removeNode(_model->index(_row, 0, group()));
+    }
+    size_t memoryCost() const override
+    {
+        return _node.memoryCost();
+    }
+    bool compact() override
+    {
+        return _node.pack();
+    }
+    Type type() const override
+    {
+        return Type::RemoveObject;
+    }
+    void write(QDataStream &stream, const ObjectRegistry &registry) const override
+    {
+        _node.write(stream, registry);
+        writeId(stream, registry, _group);
+        stream << _row;
     }
 private:
+    QModelIndex group() const
+    {
+        return _group.get() ? _model->reveal(_group.get()) : QModelIndex();
+    }
+
     SceneModel *_model;
     int _row;
-    vsg::ref_ptr<route::MVCObject> _node;
-    const QModelIndex _group;
+    PackedNodes _node;
+    ObjectRef _group;
 
 };
 
-class RenameObject : public QUndoCommand
+class RemoveNodes : public TimedCommand, public PublishedCommand, public CompactCommand, public PersistentCommand
 {
 public:
-    RenameObject(route::MVCObject *object, const QString &name, QUndoCommand *parent = nullptr) : QUndoCommand(parent)
+    RemoveNodes(SceneModel *model, const QModelIndexList &indexes, QUndoCommand *parent = nullptr) : TimedCommand(parent)
+        , _model(model)
+    {
+        std::unordered_set<const route::MVCObject*> selected;
+        for (const auto &index : indexes)
+            selected.insert(static_cast<route::MVCObject*>(index.internalPointer()));
+
+        //children of removed groups go away with them
+        auto removedWithParent = [&selected](const route::MVCObject *node)
+        {
+            for (auto parent = node->parent(); parent; parent = parent->parent())
+                if(selected.count(parent) != 0)
+                    return true;
+            return false;
+        };
+
+        std::map<route::MVCObject*, std::map<int, vsg::ref_ptr<route::MVCObject>>> groups;
+        for (const auto &index : indexes)
+        {
+            auto node = static_cast<route::MVCObject*>(index.internalPointer());
+            if(removedWithParent(node))
+                continue;
+            groups[node->parent()].emplace(index.row(), node);
+            if(auto scobj = node->cast<route::SceneObject>(); scobj)
+                scobj->setSelection(false);
+        }
+
+        int count = 0;
+        for (const auto &[group, rows] : groups)
+        {
+            std::vector<vsg::ref_ptr<route::MVCObject>> nodes;
+            for (const auto &row : rows)
+                nodes.push_back(row.second);
+            _groups.push_back({ObjectRef(group), PackedNodes(model, nodes, true)});
+            count += static_cast<int>(rows.size());
+        }
+        setText(QObject::tr("Удалены объекты (%1)").arg(count));
+    }
+    RemoveNodes(SceneModel *model, const ObjectRegistry &registry, QDataStream &stream, QUndoCommand *parent = nullptr)
+        : TimedCommand(parent)
+        , _model(model)
+    {
+        quint32 count = 0;
+        stream >> count;
+        for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+        {
+            auto parent = readObject(stream, registry);
+            _groups.push_back({parent, PackedNodes::read(stream, model, registry)});
+        }
+    }
+    void undoStep() override
+    {
+        //as with RemoveNode, nodes are appended back in their former order
+        for (auto &group : _groups)
+        {
+            _model->addNodes(_model->reveal(group.parent.get()), group.nodes.nodes());
+            group.nodes.attach();
+        }
+    }
+    void redoStep() override
+    {
+        for (auto &group : _groups)
+        {
+            _model->removeNodes(_model->reveal(group.parent.get()), group.nodes.nodes());
+            group.nodes.detach();
+        }
+    }
+    size_t memoryCost() const override
+    {
+        size_t cost = 0;
+        for (const auto &group : _groups)
+            cost += group.nodes.memoryCost();
+        return cost;
+    }
+    bool compact() override
+    {
+        bool compacted = false;
+        for (auto &group : _groups)
+            compacted = group.nodes.pack() || compacted;
+        return compacted;
+    }
+    Type type() const override
+    {
+        return Type::RemoveObjects;
+    }
+    void write(QDataStream &stream, const ObjectRegistry &registry) const override
+    {
+        stream << static_cast<quint32>(_groups.size());
+        for (const auto &group : _groups)
+        {
+            writeId(stream, registry, group.parent);
+            group.nodes.write(stream, registry);
+        }
+    }
+private:
+    struct Group
+    {
+        ObjectRef parent;
+        PackedNodes nodes;
+    };
+
+    SceneModel *_model;
+    std::vector<Group> _groups;
+};
+
+class MoveNodes : public TimedCommand, public PublishedCommand
+{
+public:
+    MoveNodes(SceneModel *model, const std::vector<vsg::ref_ptr<route::MVCObject>> &nodes, route::MVCObject *target, QUndoCommand *parent = nullptr) : TimedCommand(parent)
+        , _model(model)
+        , _nodes(nodes)
+        , _target(target)
+    {
+        std::map<route::MVCObject*, std::map<int, vsg::ref_ptr<route::MVCObject>>> groups;
+        for (const auto &node : nodes)
+            groups[node->parent()].emplace(model->reveal(node).row(), node);
+
+        for (const auto &[group, rows] : groups)
+        {
+            _groups.push_back({group, {}});
+            for (const auto &row : rows)
+                _groups.back().nodes.push_back(row.second);
+        }
+        setText(QObject::tr("Перемещены объекты (%1) в %2").arg(nodes.size()).arg(target->getName()));
+    }
+    void undoStep() override
+    {
+        _model->removeNodes(_model->reveal(_target), _nodes);
+        for (const auto &group : _groups)
+            _model->addNodes(_model->reveal(group.parent), group.nodes);
+    }
+    void redoStep() override
+    {
+        for (const auto &group : _groups)
+            _model->removeNodes(_model->reveal(group.parent), group.nodes);
+        _model->addNodes(_model->reveal(_target), _nodes);
+    }
+private:
+    struct Group
+    {
+        vsg::ref_ptr<route::MVCObject> parent;
+        std::vector<vsg::ref_ptr<route::MVCObject>> nodes;
+    };
+
+    SceneModel *_model;
+    std::vector<vsg::ref_ptr<route::MVCObject>> _nodes;
+    vsg::ref_ptr<route::MVCObject> _target;
+    std::vector<Group> _groups;
+};
+
+class RenameObject : public TimedCommand, public PublishedCommand, public PersistentCommand
+{
+public:
+    RenameObject(SceneModel *model, route::MVCObject *object, const QString &name, QUndoCommand *parent = nullptr) : TimedCommand(parent)
+        , _model(model)
         , _object(object)
         , _newName(name)
     {
         _oldName = object->getName();
         setText(QObject::tr("Oбъект %1, новое имя %2").arg(_oldName).arg(name));
     }
-    RenameObject(const QModelIndex &index, const QString &name, QUndoCommand *parent = nullptr)
-        : RenameObject(static_cast<route::MVCObject*>(index.internalPointer()), name, parent)
+    RenameObject(route::MVCObject *object, const QString &name, QUndoCommand *parent = nullptr)
+        : RenameObject(nullptr, object, name, parent)
     {
     }
-    void undo() override
+    RenameObject(SceneModel *model, const QModelIndex &index, const QString &name, QUndoCommand *parent = nullptr)
+        : RenameObject(model, static_cast<route::MVCObject*>(index.internalPointer()), name, parent)
     {
-        _object->setName(_oldName);
     }
-    void redo() override
+    RenameObject(SceneModel *model, const ObjectRegistry &registry, QDataStream &stream, QUndoCommand *parent = nullptr)
+        : TimedCommand(parent)
+        , _model(model)
+        , _object(readObject(stream, registry))
+    {
+        stream >> _oldName >> _newName;
+    }
+    void undoStep() override
     {
-        _object->setName(_newName);
+        setName(_oldName);
+    }
+    void redoStep() override
+    {
+        setName(_newName);
     }
     int id() const override
     {
@@ -152,13 +503,36 @@ public:
         if (other->id() != id())
             return false;
         auto rcmd = static_cast<const RenameObject*>(other);
-        if(rcmd->_object != _object)
+        if(rcmd->_object.get() != _object.get())
             return false;
         _newName = rcmd->_newName;
         return true;
     }
+    Type type() const override
+    {
+        return Type::RenameObject;
+    }
+    void write(QDataStream &stream, const ObjectRegistry &registry) const override
+    {
+        writeId(stream, registry, _object);
+        stream << _oldName << _newName;
+    }
+    //renames without the model are not seen by it
+    bool published() const override
+    {
+        return _model != nullptr;
+    }
 private:
-    vsg::ref_ptr<route::MVCObject> _object;
+    void setName(const QString &name)
+    {
+        if(_model)
+            _model->setName(_object.get(), name);
+        else
+            _object->setName(name);
+    }
+
+    SceneModel *_model;
+    ObjectRef _object;
     QString _oldName;
     QString _newName;
 
@@ -202,55 +576,12 @@ private:
     const vsg::dmat4 _oldMat;
     vsg::dmat4 _newMat;
 };
-
-class TransformObjects : public QUndoCommand
-{
-public:
-    TransformObjects(QSet<QModelIndex> selectedObjects, const vsg::dmat4 &delta, QUndoCommand *parent = nullptr) : QUndoCommand(parent)
-        , _selectedObjects(selectedObjects)
-        , _delta(delta)
-        , _inverse(vsg::inverse(delta))
-    {
-    }
-
-    void undo() override
-    {
-        for (auto& index : qAsConst(_selectedObjects)) {
-            auto object = static_cast<route::MVCObject*>(index.internalPointer());
-            auto transform = object->getTransform() * _inverse;
-            object->setTransform(transform);
-        }
-    }
-    void redo() override
-    {
-        for (auto& index : qAsConst(_selectedObjects)) {
-            auto object = static_cast<route::MVCObject*>(index.internalPointer());
-            auto transform = object->getTransform() * _delta;
-            object->setTransform(transform);
-        }
-    }
-    bool mergeWith(const QUndoCommand *other) override
-    {
-        if (other->id() != id())
-            return false;
-        auto rcmd = static_cast<const TransformObjects*>(other);
-        if(rcmd->_selectedObjects != _selectedObjects)
-            return false;
-        _delta = rcmd->_delta * _delta;
-        _inverse = vsg::inverse(_delta);
-        return true;
-    }
-protected:
-    QSet<QModelIndex> _selectedObjects;
-    vsg::dmat4 _delta;
-    vsg::dmat4 _inverse;
-};
 */
 
-class RotateObject : public QUndoCommand
+class RotateObject : public TimedCommand, public PersistentCommand
 {
 public:
-    RotateObject(route::MVCObject* object, const vsg::dquat &to, QUndoCommand *parent = nullptr) : QUndoCommand(parent)
+    RotateObject(route::MVCObject* object, const vsg::dquat &to, QUndoCommand *parent = nullptr) : TimedCommand(parent)
         , _object(object)
         , _final(to)
         , _initial(object->getRotation())
@@ -258,12 +589,17 @@ public:
         auto name = object->getName();
         setText(QObject::tr("Повернут объект %1").arg(name));
     }
+    RotateObject(const ObjectRegistry &registry, QDataStream &stream, QUndoCommand *parent = nullptr) : TimedCommand(parent)
+        , _object(readObject(stream, registry))
+    {
+        stream >> _initial >> _final;
+    }
 
-    void undo() override
+    void undoStep() override
     {
         _object->setRotation(_initial);
     }
-    void redo() override
+    void redoStep() override
     {
         _object->setRotation(_final);
     }
@@ -278,23 +614,32 @@ public:
         if (other->id() != id())
             return false;
         auto rcmd = static_cast<const RotateObject*>(other);
-        if(rcmd->_object != _object)
+        if(rcmd->_object.get() != _object.get())
             return false;
         _final = rcmd->_final;
         _initial = rcmd->_initial;
         return true;
     }
+    Type type() const override
+    {
+        return Type::RotateObject;
+    }
+    void write(QDataStream &stream, const ObjectRegistry &registry) const override
+    {
+        writeId(stream, registry, _object);
+        stream << _initial << _final;
+    }
 protected:
 
-    vsg::ref_ptr<route::MVCObject> _object;
+    ObjectRef _object;
     vsg::dquat _final;
     vsg::dquat _initial;
 };
 
-class MoveObject : public QUndoCommand
+class MoveObject : public TimedCommand, public PersistentCommand
 {
 public:
-    MoveObject(route::MVCObject* object, const vsg::dvec3 &to, QUndoCommand *parent = nullptr) : QUndoCommand(parent)
+    MoveObject(route::MVCObject* object, const vsg::dvec3 &to, QUndoCommand *parent = nullptr) : TimedCommand(parent)
         , _object(object)
         , _final(to)
         , _initial(object->getPosition())
@@ -302,12 +647,17 @@ public:
         auto name = object->getName();
         setText(QObject::tr("Перемещен объект %1").arg(name));
     }
+    MoveObject(const ObjectRegistry &registry, QDataStream &stream, QUndoCommand *parent = nullptr) : TimedCommand(parent)
+        , _object(readObject(stream, registry))
+    {
+        stream >> _initial >> _final;
+    }
 
-    void undo() override
+    void undoStep() override
     {
         _object->setPosition(_initial);
     }
-    void redo() override
+    void redoStep() override
     {
         _object->setPosition(_final);
     }
@@ -322,133 +672,202 @@ public:
         if (other->id() != id())
             return false;
         auto rcmd = static_cast<const MoveObject*>(other);
-        if(rcmd->_object != _object)
+        if(rcmd->_object.get() != _object.get())
             return false;
         _final = rcmd->_final;
         _initial = rcmd->_initial;
         return true;
     }
+    Type type() const override
+    {
+        return Type::MoveObject;
+    }
+    void write(QDataStream &stream, const ObjectRegistry &registry) const override
+    {
+        writeId(stream, registry, _object);
+        stream << _initial << _final;
+    }
 protected:
 
-    vsg::ref_ptr<route::MVCObject> _object;
+    ObjectRef _object;
     vsg::dvec3 _final;
     vsg::dvec3 _initial;
 };
 
-class RotateObjects : public QUndoCommand
+//Moves and rotates many objects at once.
+//Objects are addressed by registry IDs, so the command stays valid across structural changes,
+//and keeps both transforms of every object for exact undo.
+class TransformObjects : public TimedCommand, public PublishedCommand, public PersistentCommand
 {
 public:
-    RotateObjects(QSet<QModelIndex> selectedObjects, const vsg::dquat &to, QUndoCommand *parent = nullptr) : QUndoCommand(parent)
-        , _selectedObjects(selectedObjects)
-        , _final(to)
+    TransformObjects(SceneModel *model,
+                     vsg::ref_ptr<ObjectRegistry> registry,
+                     const std::vector<ObjectRegistry::ID> &ids,
+                     QUndoCommand *parent = nullptr)
+        : TimedCommand(parent)
+        , _model(model)
+        , _ids(ids)
+    {
+        _initialPositions.reserve(ids.size());
+        _initialRotations.reserve(ids.size());
+        for (auto id : ids)
+        {
+            auto object = registry->object(id);
+            _initialPositions.push_back(object ? object->getPosition() : vsg::dvec3());
+            _initialRotations.push_back(object ? object->getRotation() : vsg::dquat());
+        }
+        _finalPositions = _initialPositions;
+        _finalRotations = _initialRotations;
+    }
+    TransformObjects(SceneModel *model, QDataStream &stream, QUndoCommand *parent = nullptr)
+        : TimedCommand(parent)
+        , _model(model)
     {
-        auto object = static_cast<route::MVCObject*>(_selectedObjects.begin()->internalPointer());
-        _initial = object->getRotation();
-
-        setText(QObject::tr("Повернуты %1 объектов").arg(_selectedObjects.size()));
+        quint32 count = 0;
+        stream >> count;
+        if(stream.status() != QDataStream::Ok)
+            return;
+        _ids.resize(count);
+        _initialPositions.resize(count);
+        _finalPositions.resize(count);
+        _initialRotations.resize(count);
+        _finalRotations.resize(count);
+        for (quint32 i = 0; i < count; ++i)
+            _ids[i] = readId(stream);
+        for (quint32 i = 0; i < count; ++i)
+            stream >> _initialPositions[i] >> _finalPositions[i] >> _initialRotations[i] >> _finalRotations[i];
     }
 
-    void undo() override
+    void undoStep() override
     {
-        auto object = static_cast<route::MVCObject*>(_selectedObjects.begin()->internalPointer());
-        auto delta = _initial * tools::inverse(object->getRotation());
-        applyRotation(delta);
+        _model->setTransforms(_ids, _initialPositions, _initialRotations);
     }
-    void redo() override
+    void redoStep() override
     {
-        auto object = static_cast<route::MVCObject*>(_selectedObjects.begin()->internalPointer());
-        auto delta =  _final * tools::inverse(object->getRotation());
-        applyRotation(delta);
+        _model->setTransforms(_ids, _finalPositions, _finalRotations);
     }
 
     int id() const override
     {
-        return 3;
+        return 5;
     }
 
     bool mergeWith(const QUndoCommand *other) override
     {
         if (other->id() != id())
             return false;
-        auto rcmd = static_cast<const RotateObjects*>(other);
-        if(rcmd->_selectedObjects != _selectedObjects)
+        auto tcmd = static_cast<const TransformObjects*>(other);
+        if(tcmd->_gesture != _gesture || tcmd->_ids != _ids)
             return false;
-        _final = rcmd->_final;
-        _initial = rcmd->_initial;
+        _finalPositions = tcmd->_finalPositions;
+        _finalRotations = tcmd->_finalRotations;
         return true;
     }
-protected:
-
-    void applyRotation(const vsg::dquat &delta)
+    Type type() const override
     {
-        for (auto& index : qAsConst(_selectedObjects)) {
-            auto object = static_cast<route::MVCObject*>(index.internalPointer());
-            auto rot = delta * object->getRotation();
-            object->setRotation(rot);
-        }
+        return Type::TransformObjects;
     }
-
-    QSet<QModelIndex> _selectedObjects;
-    vsg::dquat _final;
-    vsg::dquat _initial;
-};
-
-class MoveObjects : public QUndoCommand
-{
-public:
-    MoveObjects(QSet<QModelIndex> selectedObjects, const vsg::dvec3 &delta, QUndoCommand *parent = nullptr) : QUndoCommand(parent)
-        , _selectedObjects(selectedObjects)
+    //only steps of the same gesture are merged, 0 is shared by callers that do not track gestures
+    void setGesture(quint32 gesture)
     {
-        auto object = static_cast<route::MVCObject*>(_selectedObjects.begin()->internalPointer());
-        _initial = object->getPosition();
-        _final = _initial + delta;
-
-        setText(QObject::tr("Перемещены %1 объектов").arg(_selectedObjects.size()));
+        _gesture = gesture;
     }
-
-    void undo() override
+    //false when the step leaves every object where it was, such steps are not worth an undo entry
+    bool changed() const
     {
-        auto object = static_cast<route::MVCObject*>(_selectedObjects.begin()->internalPointer());
-        auto delta = _initial - object->getPosition();
-        applyPosition(delta);
+        return _finalPositions != _initialPositions || _finalRotations != _initialRotations;
     }
-    void redo() override
+    void write(QDataStream &stream, const ObjectRegistry &) const override
     {
-        auto object = static_cast<route::MVCObject*>(_selectedObjects.begin()->internalPointer());
-        auto delta = _final - object->getPosition();
-        applyPosition(delta);
+        stream << static_cast<quint32>(_ids.size());
+        for (auto id : _ids)
+            stream << static_cast<quint64>(id);
+        for (size_t i = 0; i < _ids.size(); ++i)
+            stream << _initialPositions[i] << _finalPositions[i] << _initialRotations[i] << _finalRotations[i];
     }
+protected:
+    SceneModel *_model;
+    std::vector<ObjectRegistry::ID> _ids;
+    std::vector<vsg::dvec3> _initialPositions;
+    std::vector<vsg::dvec3> _finalPositions;
+    std::vector<vsg::dquat> _initialRotations;
+    std::vector<vsg::dquat> _finalRotations;
+    quint32 _gesture = 0;
+};
 
-    int id() const override
-    {
-        return 4;
+//rotates the objects so that the first one gets the given rotation, keeping their relative orientation
+class RotateObjects : public TransformObjects
+{
+public:
+    RotateObjects(SceneModel *model,
+                  vsg::ref_ptr<ObjectRegistry> registry,
+                  const std::vector<ObjectRegistry::ID> &ids,
+                  const vsg::dquat &to,
+                  QUndoCommand *parent = nullptr)
+        : TransformObjects(model, registry, ids, parent)
+    {
+        setText(QObject::tr("Повернуты %1 объектов").arg(ids.size()));
+        //nothing to lead the rotation, the command stays empty and changes nothing
+        if(ids.empty())
+            return;
+
+        auto delta = to * tools::inverse(_initialRotations.front());
+        for (auto &rotation : _finalRotations)
+            rotation = delta * rotation;
     }
+};
 
-    bool mergeWith(const QUndoCommand *other) override
-    {
-        if (other->id() != id())
-            return false;
-        auto rcmd = static_cast<const MoveObjects*>(other);
-        if(rcmd->_selectedObjects != _selectedObjects)
-            return false;
-        _final = rcmd->_final;
-        _initial = rcmd->_initial;
-        return true;
+class MoveObjects : public TransformObjects
+{
+public:
+    MoveObjects(SceneModel *model,
+                vsg::ref_ptr<ObjectRegistry> registry,
+                const std::vector<ObjectRegistry::ID> &ids,
+                const vsg::dvec3 &delta,
+                QUndoCommand *parent = nullptr)
+        : TransformObjects(model, registry, ids, parent)
+    {
+        for (auto &position : _finalPositions)
+            position += delta;
+
+        setText(QObject::tr("Перемещены %1 объектов").arg(ids.size()));
     }
-protected:
+};
 
-    void applyPosition(const vsg::dvec3 &delta)
-    {
-        for (auto& index : qAsConst(_selectedObjects)) {
-            auto object = static_cast<route::MVCObject*>(index.internalPointer());
-            auto pos = object->getPosition() + delta;
-            object->setPosition(pos);
-        }
+//puts every object at its own position, e.g. after a move in geographic coordinates
+class PlaceObjects : public TransformObjects
+{
+public:
+    PlaceObjects(SceneModel *model,
+                 vsg::ref_ptr<ObjectRegistry> registry,
+                 const std::vector<ObjectRegistry::ID> &ids,
+                 const std::vector<vsg::dvec3> &positions,
+                 QUndoCommand *parent = nullptr)
+        : TransformObjects(model, registry, ids, parent)
+    {
+        Q_ASSERT(positions.size() == ids.size());
+        _finalPositions = positions;
+
+        setText(QObject::tr("Перемещены %1 объектов").arg(ids.size()));
     }
+};
 
-    QSet<QModelIndex> _selectedObjects;
-    vsg::dvec3 _final;
-    vsg::dvec3 _initial;
+//transforms the objects as one rigid body by a world matrix, e.g. a rotation about the selection center
+class TransformGroup : public TransformObjects
+{
+public:
+    TransformGroup(SceneModel *model,
+                   vsg::ref_ptr<ObjectRegistry> registry,
+                   const std::vector<ObjectRegistry::ID> &ids,
+                   const GroupTransform &group,
+                   const vsg::dmat4 &world,
+                   QUndoCommand *parent = nullptr)
+        : TransformObjects(model, registry, ids, parent)
+    {
+        group.apply(world, _finalPositions, _finalRotations);
+
+        setText(QObject::tr("Преобразована группа из %1 объектов").arg(ids.size()));
+    }
 };
 
 /*
@@ -496,21 +915,21 @@ protected:
 };
 */
 
-class ConnectRails : public QUndoCommand
+class ConnectRails : public TimedCommand
 {
 public:
     ConnectRails(route::Connector *conn1, route::Connector *conn2, QUndoCommand *parent = nullptr)
-        : QUndoCommand(parent)
+        : TimedCommand(parent)
         , _conn1(conn1)
         , _conn2(conn2)
     {
         setText(QObject::tr("Соединены траектории %1 и %2").arg(conn1->trajectory->getName()).arg(conn2->trajectory->getName()));
     }
-    void undo() override
+    void undoStep() override
     {
         _conn1->disconnect();
     }
-    void redo() override
+    void redoStep() override
     {
         _conn1->connect(_conn2);
     }
@@ -527,22 +946,22 @@ public:
     {
         setText(QObject::tr("Разъеденины траектории %1 и %2").arg(_conn1->trajectory->getName()).arg(_conn2->trajectory->getName()));
     }
-    void undo() override
+    void undoStep() override
     {
-        ConnectRails::redo();
+        ConnectRails::redoStep();
     }
-    void redo() override
+    void redoStep() override
     {
-        ConnectRails::undo();
+        ConnectRails::undoStep();
     }
 };
 
 
-class AddRailPoint : public QUndoCommand
+class AddRailPoint : public TimedCommand
 {
 public:
     AddRailPoint(route::SplineTrajectory *trajectory, vsg::ref_ptr<route::RailPoint> point, QUndoCommand *parent = nullptr)
-        : QUndoCommand(parent)
+        : TimedCommand(parent)
         , _trajectory(trajectory)
         , _point(point)
     {
@@ -550,11 +969,11 @@ public:
         trajectory->getValue(app::NAME, name);
         setText(QObject::tr("Добавлена точка в траекторию %1").arg(name.c_str()));
     }
-    void undo() override
+    void undoStep() override
     {
         _trajectory->remove(_point);
     }
-    void redo() override
+    void redoStep() override
     {
         _trajectory->add(_point);
     }
@@ -563,11 +982,11 @@ private:
     vsg::ref_ptr<route::RailPoint> _point;
 };
 
-class RemoveRailPoint : public QUndoCommand
+class RemoveRailPoint : public TimedCommand
 {
 public:
     RemoveRailPoint(route::SplineTrajectory *trajectory, route::RailPoint *point, QUndoCommand *parent = nullptr)
-        : QUndoCommand(parent)
+        : TimedCommand(parent)
         , _trajectory(trajectory)
         , _point(point)
     {
@@ -575,11 +994,11 @@ public:
         trajectory->getValue(app::NAME, name);
         setText(QObject::tr("Добавлена точка в траекторию %1").arg(name.c_str()));
     }
-    void undo() override
+    void undoStep() override
     {
         _trajectory->add(_point);
     }
-    void redo() override
+    void redoStep() override
     {
         _trajectory->remove(_point);
     }
@@ -589,21 +1008,21 @@ private:
 };
 
 template<typename F, typename V>
-class ExecuteLambda : public QUndoCommand
+class ExecuteLambda : public TimedCommand
 {
 public:
-    ExecuteLambda(F func, V old, V val, int id, QUndoCommand *parent = nullptr) : QUndoCommand(parent)
+    ExecuteLambda(F func, V old, V val, int id, QUndoCommand *parent = nullptr) : TimedCommand(parent)
         , _newProp(val)
         , _oldProp(old)
         , _func(func)
         , _id(id)
     {
     }
-    void undo() override
+    void undoStep() override
     {
         _func(_oldProp);
     }
-    void redo() override
+    void redoStep() override
     {
         _func(_newProp);
     }